@@ -0,0 +1,180 @@
+# Turns a potion rule pack into a header of constexpr data, which src/BuiltinRules.h compiles into the plugin.
+# Usage: cmake -DINPUT=<rule pack .json> -DOUTPUT=<header> -P GenerateRulePack.cmake
+#
+# Form IDs are resolved here, so effects must be given as "Skyrim.esm|<hex form ID>". Skyrim.esm is always first in
+# the load order, so its form IDs never change. Only "exactly" potions are supported.
+
+cmake_minimum_required(VERSION 3.21)
+
+if(NOT INPUT OR NOT OUTPUT)
+    message(FATAL_ERROR "INPUT and OUTPUT must be set")
+endif()
+
+file(READ "${INPUT}" json)
+file(SHA1 "${INPUT}" packHash)
+string(SUBSTRING "${packHash}" 0 16 packHash)
+get_filename_component(packName "${INPUT}" NAME)
+
+function(fail message)
+    message(FATAL_ERROR "${packName}: ${message}")
+endfunction()
+
+# Escapes a string for use in a C++ string literal
+function(quote value outputVariable)
+    string(REPLACE "\\" "\\\\" value "${value}")
+    string(REPLACE "\"" "\\\"" value "${value}")
+    set(${outputVariable} "\"${value}\"sv" PARENT_SCOPE)
+endfunction()
+
+# Reads an optional member, leaving the output empty if it is missing
+function(get_optional outputVariable)
+    string(JSON value ERROR_VARIABLE error GET "${json}" ${ARGN})
+    if(error)
+        set(value "")
+    endif()
+    set(${outputVariable} "${value}" PARENT_SCOPE)
+endfunction()
+
+# Potions
+set(potionLines "")
+string(JSON potionCount ERROR_VARIABLE error LENGTH "${json}" potions)
+if(error)
+    fail("expected a \"potions\" array")
+endif()
+math(EXPR lastPotion "${potionCount} - 1")
+foreach(i RANGE ${lastPotion})
+    if(potionCount EQUAL 0)
+        break()
+    endif()
+
+    string(JSON name GET "${json}" potions ${i} name)
+    get_optional(descriptor potions ${i} descriptor)
+    get_optional(match potions ${i} match)
+    if(match AND NOT match STREQUAL "exactly")
+        fail("\"${name}\" uses \"match\": \"${match}\", built-in rule packs only support \"exactly\"")
+    endif()
+
+    # Same checks and descriptor placement as RuleParser::ParsePotion
+    string(REGEX MATCHALL "[{}]" braces "${name}")
+    list(LENGTH braces braceCount)
+    if(braceCount GREATER 0 AND (NOT braceCount EQUAL 2 OR NOT name MATCHES "{}"))
+        fail("\"${name}\" must contain 1 or fewer '{}' and no unbalanced braces")
+    endif()
+    if(name MATCHES "^{")
+        set(format "SettingsLoader::After")
+    elseif(name MATCHES "}$")
+        set(format "SettingsLoader::Before")
+    else()
+        set(format "SettingsLoader::Both")
+    endif()
+
+    string(JSON effectCount LENGTH "${json}" potions ${i} effects)
+    if(effectCount LESS 2 OR effectCount GREATER 4)
+        fail("\"${name}\" must have between 2 and 4 effects")
+    endif()
+    set(effectIDs "")
+    math(EXPR lastEffect "${effectCount} - 1")
+    foreach(j RANGE ${lastEffect})
+        string(JSON effect GET "${json}" potions ${i} effects ${j})
+        if(NOT effect MATCHES "^Skyrim\\.esm\\|(0[xX])?([0-9A-Fa-f]+)$")
+            fail("\"${name}\" uses \"${effect}\", built-in rule packs only support \"Skyrim.esm|<form ID>\" effects")
+        endif()
+        math(EXPR formID "0x${CMAKE_MATCH_2} & 0xFFFFFF" OUTPUT_FORMAT HEXADECIMAL)
+        list(APPEND effectIDs "${formID}")
+    endforeach()
+    list(JOIN effectIDs ", " effectIDs)
+
+    quote("${name}" name)
+    quote("${descriptor}" descriptor)
+    string(APPEND potionLines "        {{${effectIDs}}, ${effectCount}, ${name}, ${format}, ${descriptor}},\n")
+endforeach()
+
+# Descriptors, stored as one flat array that each category points into
+set(descriptorLines "")
+set(categoryLines "")
+set(descriptorTotal 0)
+set(categoryCount 0)
+get_optional(descriptorsJson descriptors)
+if(descriptorsJson)
+    string(JSON categoryCount LENGTH "${json}" descriptors)
+    math(EXPR lastCategory "${categoryCount} - 1")
+    foreach(i RANGE ${lastCategory})
+        if(categoryCount EQUAL 0)
+            break()
+        endif()
+        string(JSON categoryName MEMBER "${json}" descriptors ${i})
+        string(JSON descriptorCount LENGTH "${json}" descriptors "${categoryName}")
+        quote("${categoryName}" quotedName)
+        string(APPEND categoryLines "        {${quotedName}, ${descriptorTotal}, ${descriptorCount}},\n")
+
+        math(EXPR lastDescriptor "${descriptorCount} - 1")
+        foreach(j RANGE ${lastDescriptor})
+            if(descriptorCount EQUAL 0)
+                break()
+            endif()
+            string(JSON descriptor GET "${json}" descriptors "${categoryName}" ${j})
+            quote("${descriptor}" descriptor)
+            string(APPEND descriptorLines "        ${descriptor},\n")
+        endforeach()
+        math(EXPR descriptorTotal "${descriptorTotal} + ${descriptorCount}")
+    endforeach()
+endif()
+
+# Effect potencies
+set(potencyLines "")
+set(potencyCount 0)
+get_optional(potenciesJson effectPotencies)
+if(potenciesJson)
+    string(JSON potencyCount LENGTH "${json}" effectPotencies)
+    math(EXPR lastPotency "${potencyCount} - 1")
+    foreach(i RANGE ${lastPotency})
+        if(potencyCount EQUAL 0)
+            break()
+        endif()
+        string(JSON potencyName MEMBER "${json}" effectPotencies ${i})
+        string(JSON min GET "${json}" effectPotencies "${potencyName}" min)
+        string(JSON max GET "${json}" effectPotencies "${potencyName}" max)
+        get_optional(curve effectPotencies "${potencyName}" curve)
+        get_optional(exponent effectPotencies "${potencyName}" exponent)
+        if(NOT curve OR curve STREQUAL "linear")
+            set(curve "Linear")
+        elseif(curve STREQUAL "log")
+            set(curve "Log")
+        elseif(curve STREQUAL "power")
+            set(curve "Power")
+        else()
+            fail("\"${potencyName}\" uses curve \"${curve}\", built-in rule packs support linear, log and power curves")
+        endif()
+        if(NOT exponent)
+            set(exponent 1)
+        endif()
+        quote("${potencyName}" potencyName)
+        string(APPEND potencyLines
+               "        {${potencyName}, ${min}, ${max}, SettingsLoader::PotencyCurve::${curve}, ${exponent}},\n")
+    endforeach()
+endif()
+
+set(header "// Generated from ${packName} by cmake/GenerateRulePack.cmake. Do not edit.
+#pragma once
+
+namespace Settings::BuiltinRules {
+    inline constexpr std::uint64_t PACK_HASH = 0x${packHash};
+
+    inline constexpr std::array<Potion, ${potionCount}> potions = {{
+${potionLines}    }};
+
+    inline constexpr std::array<std::string_view, ${descriptorTotal}> descriptors = {{
+${descriptorLines}    }};
+
+    inline constexpr std::array<DescriptorCategory, ${categoryCount}> descriptorCategories = {{
+${categoryLines}    }};
+
+    inline constexpr std::array<Potency, ${potencyCount}> potencies = {{
+${potencyLines}    }};
+}
+")
+
+# Only touch the header when it changes, so that an unchanged pack does not trigger a rebuild
+file(WRITE "${OUTPUT}.tmp" "${header}")
+file(COPY_FILE "${OUTPUT}.tmp" "${OUTPUT}" ONLY_IF_DIFFERENT)
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,110 @@
+#include "AutoPotionRenamerAPI.h"
+
+#include "RenameEngine.h"
+
+namespace {
+    using Settings::SettingsLoader;
+
+    static_assert(APR_MAX_EFFECTS == SettingsLoader::MAX_EFFECTS);
+
+    // Keeps the names returned by the last call on each thread alive until the next one
+    struct HeldNames {
+        std::shared_ptr<const SettingsLoader::RuleSet> rules = {};
+        std::vector<std::shared_ptr<const Settings::NameGenerator::GeneratedPotion>> generated = {};
+    };
+
+    thread_local HeldNames heldNames;
+
+    // Effects looked up once per call, as a batch usually repeats the same few
+    class EffectCache {
+    public:
+        RE::EffectSetting* Find(RE::FormID effectID) {
+            const auto [it, inserted] = effects.try_emplace(effectID, nullptr);
+            if (inserted) {
+                it->second = RE::TESForm::LookupByID<RE::EffectSetting>(effectID);
+            }
+            return it->second;
+        }
+
+    private:
+        std::unordered_map<RE::FormID, RE::EffectSetting*> effects = {};
+    };
+
+    APR_NameResult QueryName(const SettingsLoader::RuleSet& rules, const APR_PotionQuery& query, EffectCache& cache) {
+        constexpr APR_NameResult unnamed = {APR_NAME_NONE, -1, -1, nullptr};
+        if (query.effectCount == 0 || query.effectCount > APR_MAX_EFFECTS) {
+            return unnamed;
+        }
+
+        RE::Effect effects[SettingsLoader::MAX_EFFECTS];
+        RE::Effect* effectPointers[SettingsLoader::MAX_EFFECTS] = {};
+        int costliestIndex = 0;
+        for (std::uint32_t i = 0; i < query.effectCount; i++) {
+            const auto& effectQuery = query.effects[i];
+            const auto baseEffect = cache.Find(effectQuery.effectID);
+            if (!baseEffect) {
+                return unnamed;
+            }
+            auto& effect = effects[i];
+            effect.baseEffect = baseEffect;
+            effect.effectItem.magnitude = effectQuery.magnitude;
+            effect.effectItem.duration = effectQuery.duration;
+            effect.cost = Hooks::PotencyEstimator::GetEffectCost(baseEffect, effectQuery.magnitude,
+                                                                 effectQuery.duration);
+            if (effect.cost > effects[costliestIndex].cost) {
+                costliestIndex = static_cast<int>(i);
+            }
+            effectPointers[i] = &effect;
+        }
+        const std::span<RE::Effect* const> effectSpan{effectPointers, query.effectCount};
+
+        APR_NameResult result = unnamed;
+        const SettingsLoader::CustomPotion* potion = Hooks::PotionEngine::FindRule(rules, effectSpan);
+        if (potion) {
+            result.source = APR_NAME_RULE;
+            result.ruleID = static_cast<std::int32_t>(potion - rules.potions.data());
+        } else if (auto generated = Hooks::PotionEngine::Generate(rules, effectSpan)) {
+            result.source = APR_NAME_GENERATED;
+            potion = &generated->potion;
+            heldNames.generated.push_back(std::move(generated));
+        } else {
+            return unnamed;
+        }
+
+        result.tier = potion->GetTier(
+            Hooks::PotencyEstimator::EstimatePotency(effectSpan, effects[costliestIndex], rules));
+        result.name = potion->names[result.tier].c_str();
+        return result;
+    }
+}
+
+extern "C" __declspec(dllexport) std::uint32_t APR_GetAPIVersion() { return APR_API_VERSION; }
+
+extern "C" __declspec(dllexport) std::uint32_t APR_QueryNames(std::uint32_t version, const APR_PotionQuery* queries,
+                                                              std::uint32_t count, APR_NameResult* results) {
+    if (version != APR_API_VERSION || (count > 0 && (!queries || !results))) {
+        return 0;
+    }
+
+    // Names from the previous call are released here, and rule names last as long as the rule set they come from
+    heldNames.generated.clear();
+    heldNames.rules = Settings::SettingsLoader::GetSingleton()->AcquireRules();
+    if (!heldNames.rules) {
+        std::fill_n(results, count, APR_NameResult{APR_NAME_NONE, -1, -1, nullptr});
+        return 0;
+    }
+
+    EffectCache cache;
+    std::uint32_t namedCount = 0;
+    for (std::uint32_t i = 0; i < count; i++) {
+        results[i] = QueryName(*heldNames.rules, queries[i], cache);
+        if (results[i].source != APR_NAME_NONE) {
+            namedCount++;
+        }
+    }
+    return namedCount;
+}
+
+// Other plugins call these through the typedefs in the header
+static_assert(std::is_same_v<decltype(&APR_GetAPIVersion), APR_GetAPIVersionFunc>);
+static_assert(std::is_same_v<decltype(&APR_QueryNames), APR_QueryNamesFunc>);
@@ -0,0 +1,58 @@
+#pragma once
+
+// Names other SKSE plugins can ask this plugin for, without reading its rules themselves. This header has no other
+// dependency and can be copied as is. The functions are looked up at runtime:
+//
+//     const auto module = GetModuleHandle(L"AutoPotionRenamer");
+//     const auto queryNames = reinterpret_cast<APR_QueryNamesFunc>(GetProcAddress(module, "APR_QueryNames"));
+//
+// Both are nullptr if the plugin is not installed.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Raised whenever the layout of the structs below changes
+#define APR_API_VERSION 1
+
+#define APR_MAX_EFFECTS 4
+
+// One effect of a potion, as it would be on the crafted potion (after alchemy skill and perks)
+typedef struct APR_EffectQuery {
+    uint32_t effectID;  // FormID of the magic effect
+    float magnitude;
+    uint32_t duration;
+} APR_EffectQuery;
+
+typedef struct APR_PotionQuery {
+    APR_EffectQuery effects[APR_MAX_EFFECTS];
+    uint32_t effectCount;
+} APR_PotionQuery;
+
+typedef enum APR_NameSource {
+    APR_NAME_NONE = 0,       // The potion keeps the name the game gives it
+    APR_NAME_RULE = 1,       // A rule from the JSON files or the built-in pack matches
+    APR_NAME_GENERATED = 2   // No rule matches, and the name is generated from the name templates
+} APR_NameSource;
+
+typedef struct APR_NameResult {
+    uint32_t source;  // APR_NameSource
+    int32_t ruleID;   // Index of the matching rule, or -1. Only stable until the rules are reloaded.
+    int32_t tier;     // Index of the name among the names the potion can be given, from least potent, or -1
+    const char* name; // UTF-8, or nullptr if the source is APR_NAME_NONE
+} APR_NameResult;
+
+// Returns APR_API_VERSION as this plugin was built with it
+typedef uint32_t (*APR_GetAPIVersionFunc)(void);
+
+// Names count potions in one call, writing one result per query. Safe to call from any thread. Returns the number of
+// potions that are given a name, or 0 without writing any results if version is not supported. Names stay valid until
+// the next call on the same thread.
+typedef uint32_t (*APR_QueryNamesFunc)(uint32_t version, const APR_PotionQuery* queries, uint32_t count,
+                                       APR_NameResult* results);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,199 @@
+#include "BatchRenamer.h"
+
+#include "AsyncLog.h"
+#include "RenameEngine.h"
+#include "logger.h"
+
+namespace Hooks {
+    using Settings::SettingsLoader;
+
+    void BatchRenamer::Start(std::array<bool, KIND_COUNT> kinds) {
+        auto batch = std::make_shared<Batch>();
+        batch->rules = SettingsLoader::GetSingleton()->AcquireRules();
+        if (!batch->rules) {
+            return;
+        }
+
+        // A budget of 0 leaves earlier potions alone, but enchantments are always renamed
+        const float budget = batch->rules->batchRenameBudget;
+        auto& potions = kinds[static_cast<std::size_t>(ItemKind::Potion)];
+        auto& enchantments = kinds[static_cast<std::size_t>(ItemKind::Enchantment)];
+        potions = potions && budget > 0.0f;
+        enchantments = enchantments && batch->rules->HasRules(ItemKind::Enchantment);
+        if (!potions && !enchantments) {
+            return;
+        }
+        batch->budget = budget > 0.0f ? budget : FALLBACK_BUDGET;
+        batch->kinds = kinds;
+        for (std::size_t i = 0; i < KIND_COUNT; i++) {
+            if (kinds[i]) {
+                batch->generations[i] = ++generations[i];
+            }
+        }
+
+        std::thread([batch]() {
+            try {
+                const auto start = std::chrono::steady_clock::now();
+                ComputeRenames(*batch, CollectCraftedItems(*batch));
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+                logger::info("Found {} crafted items to rename in {:.2f} ms", batch->renames.size(),
+                             std::chrono::duration<double, std::milli>(elapsed).count());
+                if (!batch->renames.empty()) {
+                    SKSE::GetTaskInterface()->AddTask([batch]() { ApplyRenames(batch); });
+                }
+            } catch (std::exception& e) {
+                logger::error("Failed to rename crafted items: {}", e.what());
+            }
+        }).detach();
+    }
+
+    std::vector<BatchRenamer::CraftedItem> BatchRenamer::CollectCraftedItems(const Batch& batch) {
+        std::vector<CraftedItem> craftedItems;
+        const bool potions = batch.kinds[static_cast<std::size_t>(ItemKind::Potion)];
+        const bool enchantments = batch.kinds[static_cast<std::size_t>(ItemKind::Enchantment)];
+
+        // Holding the read lock keeps the game from adding or removing forms while they are copied
+        const auto [forms, lock] = RE::TESForm::GetAllForms();
+        RE::BSReadLockGuard locker(lock);
+        if (!forms) {
+            return craftedItems;
+        }
+        for (const auto& [formID, form] : *forms) {
+            if (!form || !form->IsDynamicForm()) {
+                continue;
+            }
+            if (potions && form->GetFormType() == RE::FormType::AlchemyItem) {
+                Copy(form->As<RE::AlchemyItem>(), ItemKind::Potion, craftedItems);
+            } else if (enchantments && form->GetFormType() == RE::FormType::Enchantment) {
+                Copy(form->As<RE::EnchantmentItem>(), ItemKind::Enchantment, craftedItems);
+            }
+        }
+        return craftedItems;
+    }
+
+    template <class Item>
+    void BatchRenamer::Copy(Item* item, ItemKind kind, std::vector<CraftedItem>& craftedItems) {
+        using Traits = ItemTraits<Item>;
+
+        const auto effects = Traits::GetEffects(item);
+        const auto costliestEffect = Traits::GetCostliestEffect(item);
+        const int effectCount = static_cast<int>(effects.size());
+        if (!costliestEffect || effectCount < Traits::MIN_EFFECTS || effectCount > SettingsLoader::MAX_EFFECTS) {
+            return;  // Never renamed
+        }
+
+        CraftedItem craftedItem;
+        craftedItem.formID = item->GetFormID();
+        craftedItem.kind = kind;
+        for (const auto effect : effects) {
+            if (!effect || !effect->baseEffect) {
+                return;
+            }
+            if (effect == costliestEffect) {
+                craftedItem.costliestIndex = craftedItem.effectCount;
+            }
+            craftedItem.effects[craftedItem.effectCount++] = PotencyEstimator::Copy(*effect);
+        }
+        craftedItems.push_back(craftedItem);
+    }
+
+    void BatchRenamer::ComputeRenames(Batch& batch, const std::vector<CraftedItem>& craftedItems) {
+        const auto& rules = *batch.rules;
+
+        // Magic effects are loaded from plugins and never deleted, so they are looked up once and shared by the
+        // worker threads
+        std::unordered_map<RE::FormID, RE::EffectSetting*> baseEffects;
+        for (const auto& craftedItem : craftedItems) {
+            for (int i = 0; i < craftedItem.effectCount; i++) {
+                baseEffects.try_emplace(craftedItem.effects[i].effectID, nullptr);
+            }
+        }
+        for (auto& [effectID, baseEffect] : baseEffects) {
+            baseEffect = RE::TESForm::LookupByID<RE::EffectSetting>(effectID);
+        }
+
+        // Crafted items never change their effects, so their names can be worked out away from the main thread
+        std::vector<std::optional<RE::BSFixedString>> names(craftedItems.size());
+        std::transform(std::execution::par, craftedItems.begin(), craftedItems.end(), names.begin(),
+                       [&rules, &baseEffects](const CraftedItem& craftedItem) -> std::optional<RE::BSFixedString> {
+                           RE::Effect effects[SettingsLoader::MAX_EFFECTS];
+                           RE::Effect* effectPointers[SettingsLoader::MAX_EFFECTS] = {};
+                           for (int i = 0; i < craftedItem.effectCount; i++) {
+                               const auto& copy = craftedItem.effects[i];
+                               auto& effect = effects[i];
+                               effect.baseEffect = baseEffects.at(copy.effectID);
+                               if (!effect.baseEffect) {
+                                   return std::nullopt;
+                               }
+                               effect.effectItem.magnitude = copy.magnitude;
+                               effect.effectItem.duration = copy.duration;
+                               effect.cost = copy.cost;
+                               effectPointers[i] = &effect;
+                           }
+
+                           const std::span<RE::Effect* const> effectSpan{
+                               effectPointers, static_cast<std::size_t>(craftedItem.effectCount)};
+                           const auto& costliestEffect = effects[craftedItem.costliestIndex];
+                           if (craftedItem.kind == ItemKind::Enchantment) {
+                               return EnchantmentEngine::GetName(rules, effectSpan, costliestEffect);
+                           }
+                           return PotionEngine::GetName(rules, effectSpan, costliestEffect);
+                       });
+
+        for (std::size_t i = 0; i < craftedItems.size(); i++) {
+            if (names[i]) {
+                batch.renames.push_back({craftedItems[i].formID, craftedItems[i].kind, *names[i]});
+            }
+        }
+    }
+
+    void BatchRenamer::ApplyRenames(std::shared_ptr<Batch> batch) {
+        // Kinds that a later batch has taken over, or that were cancelled, are skipped
+        std::array<bool, KIND_COUNT> current = {};
+        bool anyCurrent = false;
+        for (std::size_t i = 0; i < KIND_COUNT; i++) {
+            current[i] = batch->kinds[i] && batch->generations[i] == generations[i].load();
+            anyCurrent |= current[i];
+        }
+        if (!anyCurrent) {
+            logger::info("Stopped renaming crafted items, the batch was cancelled or replaced");
+            return;
+        }
+
+        const auto budget = std::chrono::duration<float, std::milli>(batch->budget);
+        const auto start = std::chrono::steady_clock::now();
+        int renamed = 0;
+        while (batch->next < batch->renames.size() && std::chrono::steady_clock::now() - start < budget) {
+            const auto& [formID, kind, name] = batch->renames[batch->next++];
+            if (!current[static_cast<std::size_t>(kind)]) {
+                continue;
+            }
+
+            // Looked up again in case the form was deleted since the batch was computed
+            const auto form = RE::TESForm::LookupByID(formID);
+            if (kind == ItemKind::Enchantment) {
+                renamed += Apply<RE::EnchantmentItem>(form, name);
+            } else {
+                renamed += Apply<RE::AlchemyItem>(form, name);
+            }
+        }
+        APR_DEBUG("Renamed {} crafted items this frame", renamed);
+
+        // Tasks queued while the task queue is running are run on the next frame
+        if (batch->next < batch->renames.size()) {
+            SKSE::GetTaskInterface()->AddTask([batch]() { ApplyRenames(batch); });
+        } else {
+            logger::info("Finished renaming crafted items");
+        }
+    }
+
+    template <class Item>
+    bool BatchRenamer::Apply(RE::TESForm* form, const RE::BSFixedString& name) {
+        const auto item = form ? form->As<Item>() : nullptr;
+        if (!item || item->fullName == name) {
+            return false;
+        }
+        ItemTraits<Item>::SetName(item, name);
+        return true;
+    }
+}
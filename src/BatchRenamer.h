@@ -0,0 +1,89 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+namespace Hooks {
+    // Renames items that were crafted before the current rules were loaded, such as those in a save, and enchantments
+    // once the crafting menu they were made in is closed
+    class BatchRenamer {
+    private:
+        using ItemKind = Settings::SettingsLoader::ItemKind;
+
+        static constexpr std::size_t KIND_COUNT = static_cast<std::size_t>(ItemKind::Count);
+
+        // Per-frame budget in milliseconds for enchantments when batchRenameBudget is 0, which only leaves potions
+        // alone
+        static constexpr float FALLBACK_BUDGET = 0.5f;
+
+        struct PendingRename {
+            RE::FormID formID;
+            ItemKind kind;
+            RE::BSFixedString name;
+        };
+
+        // What naming needs from a crafted item, copied while the form map is locked. The game may delete the item
+        // once the lock is released, so names are computed from these copies and never from the form.
+        struct CraftedItem {
+            RE::FormID formID = 0;
+            ItemKind kind = ItemKind::Potion;
+            Settings::CraftedEffect effects[Settings::SettingsLoader::MAX_EFFECTS] = {};
+            int effectCount = 0;
+            int costliestIndex = 0;
+        };
+
+        // Renames computed on a worker thread, waiting to be applied on the main thread
+        struct Batch {
+            std::shared_ptr<const Settings::SettingsLoader::RuleSet> rules;
+            std::vector<PendingRename> renames;
+            std::size_t next = 0;
+            float budget = 0.0f;
+
+            // Kinds of item renamed by this batch, and the generation of each when it was started
+            std::array<bool, KIND_COUNT> kinds = {};
+            std::array<std::uint32_t, KIND_COUNT> generations = {};
+        };
+
+        // Incremented for each kind by every Start that covers it, so that an outdated batch stops applying names
+        // of that kind while still applying the others
+        inline static std::array<std::atomic_uint32_t, KIND_COUNT> generations = {};
+
+        static void Start(std::array<bool, KIND_COUNT> kinds);
+
+        static std::vector<CraftedItem> CollectCraftedItems(const Batch& batch);
+
+        template <class Item>
+        static void Copy(Item* item, ItemKind kind, std::vector<CraftedItem>& craftedItems);
+
+        static void ComputeRenames(Batch& batch, const std::vector<CraftedItem>& craftedItems);
+
+        static void ApplyRenames(std::shared_ptr<Batch> batch);
+
+        template <class Item>
+        static bool Apply(RE::TESForm* form, const RE::BSFixedString& name);
+
+    public:
+        BatchRenamer() = delete;
+
+        // Computes names for every crafted item on a worker thread, then applies them on the main thread a few at a
+        // time, within the per-frame budget set in UserSettings.json. Replaces any batch that is still running.
+        static void Start() {
+            std::array<bool, KIND_COUNT> kinds;
+            kinds.fill(true);
+            Start(kinds);
+        }
+
+        // The same for one kind of item only, replacing only that kind in a running batch
+        static void Start(ItemKind kind) {
+            std::array<bool, KIND_COUNT> kinds = {};
+            kinds[static_cast<std::size_t>(kind)] = true;
+            Start(kinds);
+        }
+
+        // Stops a running batch from applying any more names, e.g. before its forms are unloaded
+        static void Cancel() {
+            for (auto& generation : generations) {
+                ++generation;
+            }
+        }
+    };
+}
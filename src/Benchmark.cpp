@@ -0,0 +1,232 @@
+#include "Benchmark.h"
+
+#include "BenchmarkUtils.h"
+#include "logger.h"
+#include "RenameEngine.h"
+#include "RuleParser.h"
+
+namespace Diagnostics {
+    using Settings::SettingsLoader;
+
+    bool Benchmark::Start() {
+        if (running.exchange(true)) {
+            return false;
+        }
+
+        const auto logDirectory = SKSE::log::log_directory();
+        if (!logDirectory) {
+            running.store(false);
+            return false;
+        }
+        const auto outputPath = *logDirectory / "AutoPotionRenamerBenchmark.jsonl";
+
+        std::thread([outputPath]() {
+            logger::info("Starting benchmark...");
+            try {
+                Run(outputPath);
+                logger::info("Benchmark results written to {}", outputPath.string());
+            } catch (std::exception& e) {
+                logger::error("Benchmark failed: {}", e.what());
+            }
+            running.store(false);
+        }).detach();
+        return true;
+    }
+
+    void Benchmark::Run(const std::filesystem::path& outputPath) {
+        const auto dataHandler = RE::TESDataHandler::GetSingleton();
+        if (!dataHandler) {
+            throw std::runtime_error("Data handler not found");
+        }
+
+        // Real magic effects, so that potency estimation reads real effect data
+        std::vector<RE::EffectSetting*> effectPool;
+        for (const auto effect : dataHandler->GetFormArray<RE::EffectSetting>()) {
+            if (effect) {
+                effectPool.push_back(effect);
+            }
+        }
+        if (effectPool.size() < SettingsLoader::MAX_EFFECTS) {
+            throw std::runtime_error("Not enough magic effects loaded");
+        }
+
+        std::ofstream output(outputPath, std::ios::trunc);
+        output << std::format("{{\"benchmark\":\"info\",\"effectPool\":{},\"craftedPotions\":{},\"passes\":{}}}\n",
+                              effectPool.size(), CRAFTED_POTIONS, PASSES);
+
+        for (const int ruleCount : RULE_COUNTS) {
+            for (int effectCount = 2; effectCount <= SettingsLoader::MAX_EFFECTS; effectCount++) {
+                RunPipeline(output, effectPool, ruleCount, effectCount);
+            }
+        }
+
+        for (const int fileCount : FILE_COUNTS) {
+            for (const int potionsPerFile : POTIONS_PER_FILE) {
+                RunParsing(output, effectPool, fileCount, potionsPerFile);
+            }
+        }
+    }
+
+    std::unique_ptr<SettingsLoader::RuleSet> Benchmark::MakeRules(const std::vector<RE::EffectSetting*>& effectPool,
+                                                                  int ruleCount, int effectCount) {
+        auto rules = std::make_unique<SettingsLoader::RuleSet>();
+        Random random(static_cast<std::uint64_t>(ruleCount) * 31 + effectCount);
+
+        std::unordered_set<SettingsLoader::EffectSignature, SettingsLoader::EffectSignatureHash> signatures;
+        for (int attempt = 0; (int)rules->potions.size() < ruleCount && attempt < ruleCount * 10; attempt++) {
+            RE::EffectSetting* picked[SettingsLoader::MAX_EFFECTS] = {};
+            PickDistinct<RE::EffectSetting*>(random, effectPool, effectCount, picked);
+
+            RE::FormID effectIDs[SettingsLoader::MAX_EFFECTS] = {};
+            for (int i = 0; i < effectCount; i++) {
+                effectIDs[i] = picked[i]->GetFormID();
+            }
+            if (signatures.emplace(effectIDs, effectCount).second) {
+                const auto name = rules->strings.Intern(std::format("Benchmark{{}}Potion {}", rules->potions.size()));
+                rules->potions.push_back({effectIDs, name, SettingsLoader::Both, effectCount});
+            }
+        }
+
+        for (const auto effect : effectPool) {
+            rules->potencies.records.push_back(
+                {effect->GetFormID(), 5.0f, 1.0f / 95.0f, SettingsLoader::GetPotencyDriver(effect)});
+        }
+        rules->potencies.Sort();
+
+        SettingsLoader::FinishRules(*rules);
+        return rules;
+    }
+
+    void Benchmark::RunPipeline(std::ofstream& output, const std::vector<RE::EffectSetting*>& effectPool,
+                                int ruleCount, int effectCount) {
+        using Hooks::PotencyEstimator;
+        using Hooks::PotionEngine;
+
+        std::unique_ptr<SettingsLoader::RuleSet> rules;
+        const double buildNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() { rules = MakeRules(effectPool, ruleCount, effectCount); }, 1);
+
+        // Half of the crafted potions copy a rule's effects in a shuffled order, the other half are random
+        Random random(static_cast<std::uint64_t>(ruleCount) * 17 + effectCount);
+        const auto effects = std::make_unique<RE::Effect[]>(CRAFTED_POTIONS * effectCount);
+        std::vector<RE::BSTArray<RE::Effect*>> craftedPotions(CRAFTED_POTIONS);
+        for (int i = 0; i < CRAFTED_POTIONS; i++) {
+            RE::EffectSetting* picked[SettingsLoader::MAX_EFFECTS] = {};
+            if (i % 2 == 0) {
+                const auto& potion = rules->potions[random.Next(static_cast<std::uint32_t>(rules->potions.size()))];
+                for (int j = 0; j < effectCount; j++) {
+                    picked[j] = RE::TESForm::LookupByID<RE::EffectSetting>(potion.effectIDs[j]);
+                }
+                std::shuffle(picked, picked + effectCount, std::minstd_rand(i));
+            } else {
+                PickDistinct<RE::EffectSetting*>(random, effectPool, effectCount, picked);
+            }
+
+            for (int j = 0; j < effectCount; j++) {
+                auto& effect = effects[i * effectCount + j];
+                effect.baseEffect = picked[j];
+                effect.effectItem.magnitude = random.NextFloat(0.0f, 120.0f);
+                effect.effectItem.duration = random.Next(300);
+                craftedPotions[i].push_back(&effect);
+            }
+        }
+
+        const std::int64_t operations = static_cast<std::int64_t>(CRAFTED_POTIONS) * PASSES;
+        std::vector<const SettingsLoader::CustomPotion*> matches(CRAFTED_POTIONS);
+        std::vector<float> potencies(CRAFTED_POTIONS);
+
+        const double matchNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() {
+                for (int pass = 0; pass < PASSES; pass++) {
+                    for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                        matches[i] = PotionEngine::FindRule(*rules, craftedPotions[i]);
+                    }
+                }
+            },
+            operations);
+
+        const double potencyNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() {
+                for (int pass = 0; pass < PASSES; pass++) {
+                    for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                        const auto& effects = craftedPotions[i];
+                        potencies[i] = PotencyEstimator::EstimatePotency(effects, *effects[0], *rules);
+                    }
+                }
+            },
+            operations);
+
+        RE::BSFixedString name;
+        const double nameNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() {
+                for (int pass = 0; pass < PASSES; pass++) {
+                    for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                        if (matches[i]) {
+                            name = matches[i]->GetName(potencies[i]);
+                        }
+                    }
+                }
+            },
+            operations);
+
+        const double pipelineNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() {
+                for (int pass = 0; pass < PASSES; pass++) {
+                    for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                        if (const auto potion = PotionEngine::FindRule(*rules, craftedPotions[i])) {
+                            const auto& effects = craftedPotions[i];
+                            name = potion->GetName(PotencyEstimator::EstimatePotency(effects, *effects[0], *rules));
+                        }
+                    }
+                }
+            },
+            operations);
+        sink = reinterpret_cast<std::uintptr_t>(name.data());
+
+        const auto matched = std::count_if(matches.begin(), matches.end(), [](auto match) { return match; });
+        const std::pair<const char*, double> stages[] = {{"build", buildNanoseconds},
+                                                         {"match", matchNanoseconds},
+                                                         {"potency", potencyNanoseconds},
+                                                         {"name", nameNanoseconds},
+                                                         {"pipeline", pipelineNanoseconds}};
+        for (const auto& [stage, nanoseconds] : stages) {
+            output << std::format(
+                "{{\"benchmark\":\"{}\",\"rules\":{},\"effects\":{},\"matched\":{},\"nsPerOp\":{:.2f}}}\n", stage,
+                rules->potions.size(), effectCount, matched, nanoseconds);
+        }
+        output.flush();
+    }
+
+    void Benchmark::RunParsing(std::ofstream& output, const std::vector<RE::EffectSetting*>& effectPool,
+                               int fileCount, int potionsPerFile) {
+        Random random(static_cast<std::uint64_t>(fileCount) * 13 + potionsPerFile);
+
+        std::vector<RE::FormID> effectIDs;
+        for (const auto effect : effectPool) {
+            effectIDs.push_back(effect->GetFormID());
+        }
+        const std::string json = MakeRuleFileJson(random, effectIDs, potionsPerFile);
+
+        std::vector<Settings::RuleFile> ruleFiles(fileCount);
+        const auto parse = [&](Settings::RuleFile& ruleFile) {
+            std::istringstream stream(json);
+            ruleFile = {};
+            Settings::RuleParser::ParsePotionStream(stream, "Benchmark.json", ruleFile);
+        };
+
+        const double serialNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() { std::for_each(ruleFiles.begin(), ruleFiles.end(), parse); }, 1);
+        const double parallelNanoseconds = MeasureNanosecondsPerOperation(
+            [&]() { std::for_each(std::execution::par, ruleFiles.begin(), ruleFiles.end(), parse); }, 1);
+
+        const std::pair<const char*, double> modes[] = {{"serial", serialNanoseconds},
+                                                        {"parallel", parallelNanoseconds}};
+        for (const auto& [mode, nanoseconds] : modes) {
+            output << std::format(
+                "{{\"benchmark\":\"parse\",\"mode\":\"{}\",\"files\":{},\"potionsPerFile\":{},\"bytesPerFile\":{},"
+                "\"msTotal\":{:.3f}}}\n",
+                mode, fileCount, potionsPerFile, json.size(), nanoseconds / 1e6);
+        }
+        output.flush();
+    }
+}
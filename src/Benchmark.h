@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+namespace Diagnostics {
+    // Times each stage of the rename pipeline against synthetic rule sets and potions, plus JSON parsing
+    class Benchmark {
+    private:
+        static constexpr int RULE_COUNTS[] = {10, 100, 1000, 10000, 100000};
+        static constexpr int FILE_COUNTS[] = {1, 10, 100};
+        static constexpr int POTIONS_PER_FILE[] = {10, 100, 1000};
+
+        // Crafted potions per rule set, half of which match a rule
+        static constexpr int CRAFTED_POTIONS = 1024;
+        // Passes over the crafted potions for each measurement
+        static constexpr int PASSES = 64;
+
+        inline static std::atomic_bool running = false;
+
+        static void Run(const std::filesystem::path& outputPath);
+
+        static void RunPipeline(std::ofstream& output, const std::vector<RE::EffectSetting*>& effectPool,
+                                int ruleCount, int effectCount);
+
+        static void RunParsing(std::ofstream& output, const std::vector<RE::EffectSetting*>& effectPool,
+                               int fileCount, int potionsPerFile);
+
+        static std::unique_ptr<Settings::SettingsLoader::RuleSet> MakeRules(
+            const std::vector<RE::EffectSetting*>& effectPool, int ruleCount, int effectCount);
+
+    public:
+        Benchmark() = delete;
+
+        // Runs on a worker thread and writes one JSON object per measurement to AutoPotionRenamerBenchmark.jsonl
+        // in the SKSE log directory. Returns false if a benchmark is already running.
+        static bool Start();
+    };
+}
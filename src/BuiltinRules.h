@@ -0,0 +1,129 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+// A rule pack compiled into the plugin by cmake/GenerateRulePack.cmake (the APR_BUILTIN_RULE_PACK CMake option).
+// Its potions are found through a minimal perfect hash built at compile time, and are only used when no potion from
+// the JSON files matches.
+#ifdef APR_BUILTIN_RULES
+
+namespace Settings::BuiltinRules {
+    struct Potion {
+        RE::FormID effectIDs[SettingsLoader::MAX_EFFECTS];
+        int effectCount;
+        std::string_view name;
+        SettingsLoader::DescriptorFormat format;
+        std::string_view descriptor;
+    };
+
+    // A range of the descriptors array
+    struct DescriptorCategory {
+        std::string_view name;
+        int first;
+        int count;
+    };
+
+    struct Potency {
+        std::string_view name;
+        float min;
+        float max;
+        SettingsLoader::PotencyCurve curve;
+        float exponent;
+    };
+}
+
+    #include "BuiltinRulePack.h"
+
+namespace Settings::BuiltinRules {
+    using EffectSignature = SettingsLoader::EffectSignature;
+
+    // Picks a slot within a bucket; each bucket searches for a seed that sends its potions to free slots
+    constexpr std::size_t SeededHash(const EffectSignature& signature, std::uint32_t seed) {
+        std::uint64_t hash = SettingsLoader::EffectSignatureHash{}(signature) ^ (seed * 0x9E3779B97F4A7C15ull);
+        hash ^= hash >> 29;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+
+    // Not constexpr, so that a pack with repeated effects fails to compile with this name in the error
+    void DuplicateEffectsInBuiltinRulePack();
+
+    template <std::size_t N>
+    struct PerfectHash {
+        std::array<EffectSignature, N> signatures = {};
+        std::array<std::uint32_t, N> seeds = {};
+        std::array<int, N> slots = {};
+    };
+
+    template <std::size_t N>
+    consteval PerfectHash<N> BuildPerfectHash(const std::array<Potion, N>& packPotions) {
+        PerfectHash<N> table;
+        std::array<int, N> buckets = {};
+        std::array<int, N> bucketSizes = {};
+        for (std::size_t i = 0; i < N; i++) {
+            table.signatures[i] = EffectSignature(packPotions[i].effectIDs, packPotions[i].effectCount);
+            for (std::size_t j = 0; j < i; j++) {
+                if (table.signatures[i] == table.signatures[j]) {
+                    DuplicateEffectsInBuiltinRulePack();
+                }
+            }
+            buckets[i] = static_cast<int>(SettingsLoader::EffectSignatureHash{}(table.signatures[i]) % N);
+            bucketSizes[buckets[i]]++;
+        }
+
+        // Place the largest buckets first, while there is the most room
+        std::array<int, N> order = {};
+        for (std::size_t i = 0; i < N; i++) {
+            order[i] = static_cast<int>(i);
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return bucketSizes[a] > bucketSizes[b]; });
+
+        std::array<bool, N> occupied = {};
+        for (const int bucket : order) {
+            if (bucketSizes[bucket] == 0) {
+                break;
+            }
+            for (std::uint32_t seed = 1;; seed++) {
+                std::array<std::size_t, N> placedSlots = {};
+                std::array<int, N> placedPotions = {};
+                int placedCount = 0;
+                bool fits = true;
+                for (std::size_t i = 0; i < N && fits; i++) {
+                    if (buckets[i] != bucket) {
+                        continue;
+                    }
+                    const auto slot = SeededHash(table.signatures[i], seed) % N;
+                    const auto placedEnd = placedSlots.begin() + placedCount;
+                    fits = !occupied[slot] && std::find(placedSlots.begin(), placedEnd, slot) == placedEnd;
+                    placedSlots[placedCount] = slot;
+                    placedPotions[placedCount++] = static_cast<int>(i);
+                }
+                if (fits) {
+                    for (int i = 0; i < placedCount; i++) {
+                        occupied[placedSlots[i]] = true;
+                        table.slots[placedSlots[i]] = placedPotions[i];
+                    }
+                    table.seeds[bucket] = seed;
+                    break;
+                }
+            }
+        }
+        return table;
+    }
+
+    inline constexpr auto potionTable = BuildPerfectHash(potions);
+
+    // Returns the index of the pack potion with exactly the given effects, or -1 if there is none
+    inline int FindPotion(const EffectSignature& signature) {
+        constexpr std::size_t N = potions.size();
+        if constexpr (N == 0) {
+            return -1;
+        } else {
+            const auto bucket = SettingsLoader::EffectSignatureHash{}(signature) % N;
+            const int index = potionTable.slots[SeededHash(signature, potionTable.seeds[bucket]) % N];
+            return potionTable.signatures[index] == signature ? index : -1;
+        }
+    }
+}
+
+#endif
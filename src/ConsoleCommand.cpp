@@ -0,0 +1,86 @@
+#include "ConsoleCommand.h"
+
+#include "Benchmark.h"
+#include "Coverage.h"
+#include "CraftTrace.h"
+#include "logger.h"
+#include "Profiler.h"
+#include "SettingsLoader.h"
+
+namespace Console {
+    void ConsoleCommand::Register() {
+        const auto command = RE::SCRIPT_FUNCTION::LocateConsoleCommand(REPLACED_COMMAND);
+        if (!command) {
+            logger::error("Could not find the {} console command, \"apr\" will not be available", REPLACED_COMMAND);
+            return;
+        }
+
+        static RE::SCRIPT_PARAMETER params[] = {{"Command", RE::SCRIPT_PARAM_TYPE::kChar, false}};
+
+        command->functionName = "AutoPotionRenamer";
+        command->shortName = "apr";
+        command->helpString = USAGE;
+        command->referenceFunction = false;
+        command->SetParameters(params);
+        command->executeFunction = &Execute;
+        command->conditionFunction = nullptr;
+
+        logger::info("Registered \"apr\" console command");
+    }
+
+    bool ConsoleCommand::Execute(const RE::SCRIPT_PARAMETER*, RE::SCRIPT_FUNCTION::ScriptData* a_scriptData,
+                                 RE::TESObjectREFR*, RE::TESObjectREFR*, RE::Script*, RE::ScriptLocals*, double&,
+                                 std::uint32_t&) {
+        const auto argument = a_scriptData->GetStringChunk()->GetString();
+
+        if (argument == "reload") {
+            using ReloadStatus = Settings::SettingsLoader::ReloadStatus;
+            switch (Settings::SettingsLoader::GetSingleton()->ReloadSettings()) {
+                case ReloadStatus::Started:
+                    Print("Reloading potion rules, see AutoPotionRenamer.log for details");
+                    break;
+                case ReloadStatus::NotLoaded:
+                    Print("Potion rules cannot be reloaded until the game data has loaded");
+                    break;
+                case ReloadStatus::Busy:
+                    Print("Potion rules are already being reloaded");
+                    break;
+            }
+        } else if (argument == "bench") {
+            if (Diagnostics::Benchmark::Start()) {
+                Print("Benchmark started, results will be written to AutoPotionRenamerBenchmark.jsonl");
+            } else {
+                Print("A benchmark is already running");
+            }
+        } else if (argument == "replay") {
+            if (Diagnostics::CraftTrace::StartReplay()) {
+                Print("Replaying recorded crafts, see AutoPotionRenamer.log for the results");
+            } else {
+                Print("A replay is already running");
+            }
+        } else if (argument == "stats") {
+#ifdef APR_PROFILING
+            for (const auto& line : Diagnostics::Profiler::Dump()) {
+                Print(line);
+            }
+#else
+            Print("This build was made without APR_PROFILING, so no stats are collected");
+#endif
+        } else if (argument == "coverage") {
+            if (Diagnostics::Coverage::Start()) {
+                Print("Checking rule coverage of ingredient combinations, see AutoPotionRenamer.log for the results");
+            } else {
+                Print("Rule coverage is already being checked");
+            }
+        } else {
+            Print(USAGE);
+        }
+        return true;
+    }
+
+    void ConsoleCommand::Print(const std::string& message) {
+        if (const auto console = RE::ConsoleLog::GetSingleton()) {
+            console->Print("%s", message.c_str());
+        }
+    }
+}
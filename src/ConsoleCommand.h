@@ -0,0 +1,22 @@
+#pragma once
+
+namespace Console {
+    class ConsoleCommand {
+    private:
+        // Obsolete vanilla command that is taken over by this plugin
+        static constexpr auto REPLACED_COMMAND = "TestSeenData"sv;
+
+        static constexpr auto USAGE = "Usage: apr <reload|bench|replay|stats|coverage>";
+
+        static bool Execute(const RE::SCRIPT_PARAMETER* a_paramInfo, RE::SCRIPT_FUNCTION::ScriptData* a_scriptData,
+                            RE::TESObjectREFR* a_thisObj, RE::TESObjectREFR* a_containingObj, RE::Script* a_scriptObj,
+                            RE::ScriptLocals* a_locals, double& a_result, std::uint32_t& a_opcodeOffsetPtr);
+
+        static void Print(const std::string& message);
+
+    public:
+        ConsoleCommand() = delete;
+
+        static void Register();
+    };
+}
@@ -0,0 +1,100 @@
+#include "AsyncLog.h"
+
+namespace Diagnostics {
+    void AsyncLog::Start() {
+        if (running.exchange(true)) {
+            return;
+        }
+        slots = std::make_unique<Slot[]>(CAPACITY);
+        for (std::size_t i = 0; i < CAPACITY; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        std::thread(Drain).detach();
+    }
+
+    void AsyncLog::Push(spdlog::level::level_enum level, std::string_view format,
+                        std::initializer_list<Argument> arguments) {
+        if (!running.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        // Claim a slot without locking; if every slot is still waiting to be written out, drop the message rather
+        // than stall the caller
+        std::size_t position = writePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & (CAPACITY - 1)];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = writePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto& record = slot->record;
+        record.format = format;
+        record.level = level;
+        record.argumentCount = static_cast<std::uint8_t>(arguments.size());
+        std::size_t textUsed = 0;
+        int i = 0;
+        for (auto argument : arguments) {
+            if (argument.kind == Argument::Kind::Text) {
+                const auto size = std::min(argument.text.size, TEXT_SIZE - textUsed);
+                std::memcpy(record.text + textUsed, argument.text.data, size);
+                argument.text = {record.text + textUsed, size};
+                textUsed += size;
+            }
+            record.arguments[i++] = argument;
+        }
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    void AsyncLog::Drain() {
+        std::size_t position = 0;
+        while (true) {
+            auto& slot = slots[position & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                if (const auto count = dropped.exchange(0, std::memory_order_relaxed)) {
+                    logger::warn("Dropped {} trace messages, the log buffer was full", count);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+
+            spdlog::default_logger_raw()->log(slot.record.level, Format(slot.record));
+
+            // Hand the slot back to writers for its next lap around the buffer
+            slot.sequence.store(position + CAPACITY, std::memory_order_release);
+            position++;
+        }
+    }
+
+    std::string AsyncLog::Format(const Record& record) {
+        const auto& arguments = record.arguments;
+        try {
+            switch (record.argumentCount) {
+                case 0:
+                    return std::string(record.format);
+                case 1:
+                    return std::vformat(record.format, std::make_format_args(arguments[0]));
+                case 2:
+                    return std::vformat(record.format, std::make_format_args(arguments[0], arguments[1]));
+                case 3:
+                    return std::vformat(record.format,
+                                        std::make_format_args(arguments[0], arguments[1], arguments[2]));
+                default:
+                    return std::vformat(record.format, std::make_format_args(arguments[0], arguments[1],
+                                                                             arguments[2], arguments[3]));
+            }
+        } catch (std::format_error& e) {
+            return std::format("Failed to format \"{}\": {}", record.format, e.what());
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+namespace Diagnostics {
+    // Trace and debug messages for hot paths. The calling thread only copies the raw arguments into a lock-free ring
+    // buffer; a background thread formats them and writes them to the log set up by SetupLog. Use through the
+    // APR_TRACE and APR_DEBUG macros below, which do not evaluate their arguments when the level is disabled.
+    class AsyncLog {
+    public:
+        // An argument stored as its raw value, then formatted with its format spec on the background thread
+        class Argument {
+        public:
+            enum class Kind : std::uint8_t { Signed, Unsigned, Float, Text };
+
+            Argument() : kind(Kind::Unsigned), unsignedValue(0) {}
+
+            template <std::integral T>
+                requires(!std::same_as<T, bool>)
+            Argument(T value) {
+                if constexpr (std::is_signed_v<T>) {
+                    kind = Kind::Signed;
+                    signedValue = value;
+                } else {
+                    kind = Kind::Unsigned;
+                    unsignedValue = value;
+                }
+            }
+
+            Argument(std::floating_point auto value) : kind(Kind::Float), floatValue(value) {}
+
+            Argument(bool value) : Argument(value ? "true"sv : "false"sv) {}
+
+            Argument(std::string_view value) : kind(Kind::Text), text{value.data(), value.size()} {}
+
+            Argument(const char* value) : Argument(std::string_view(value)) {}
+
+            Argument(const std::string& value) : Argument(std::string_view(value)) {}
+
+            Kind kind;
+            union {
+                std::int64_t signedValue;
+                std::uint64_t unsignedValue;
+                double floatValue;
+                struct {
+                    const char* data;
+                    std::size_t size;
+                } text;
+            };
+        };
+
+        static constexpr std::size_t MAX_ARGUMENTS = 4;
+
+        AsyncLog() = delete;
+
+        // Starts the thread that writes messages to the log. Messages written before this are dropped.
+        static void Start();
+
+        template <class... Args>
+        static void Write(spdlog::level::level_enum level, std::format_string<Args...> format, Args&&... args) {
+            static_assert(sizeof...(Args) <= MAX_ARGUMENTS, "Too many arguments for an asynchronous log message");
+            Push(level, format.get(), {Argument(args)...});
+        }
+
+    private:
+        // Must be a power of two
+        static constexpr std::size_t CAPACITY = 4096;
+
+        // Text arguments are copied here, and truncated once it is full
+        static constexpr std::size_t TEXT_SIZE = 128;
+
+        struct Record {
+            std::string_view format;
+            spdlog::level::level_enum level;
+            std::uint8_t argumentCount;
+            std::array<Argument, MAX_ARGUMENTS> arguments;
+            char text[TEXT_SIZE];
+        };
+
+        // A slot is free for the writer at position p when its sequence is p, and ready to read when it is p + 1
+        struct Slot {
+            std::atomic<std::size_t> sequence;
+            Record record;
+        };
+
+        inline static std::unique_ptr<Slot[]> slots = {};
+        inline static std::atomic<std::size_t> writePosition = 0;
+        inline static std::atomic_bool running = false;
+
+        // Messages lost because the buffer was full, reported by the background thread
+        inline static std::atomic<std::uint64_t> dropped = 0;
+
+        static void Push(spdlog::level::level_enum level, std::string_view format,
+                         std::initializer_list<Argument> arguments);
+
+        static void Drain();
+
+        static std::string Format(const Record& record);
+    };
+}
+
+template <>
+struct std::formatter<Diagnostics::AsyncLog::Argument> {
+    // The spec is kept as written, and applied to the argument's original type when it is formatted
+    std::string spec = "{:";
+
+    constexpr auto parse(std::format_parse_context& context) {
+        auto it = context.begin();
+        while (it != context.end() && *it != '}') {
+            spec += *it++;
+        }
+        spec += '}';
+        return it;
+    }
+
+    auto format(const Diagnostics::AsyncLog::Argument& argument, std::format_context& context) const {
+        using Kind = Diagnostics::AsyncLog::Argument::Kind;
+        switch (argument.kind) {
+            case Kind::Signed:
+                return std::vformat_to(context.out(), spec, std::make_format_args(argument.signedValue));
+            case Kind::Unsigned:
+                return std::vformat_to(context.out(), spec, std::make_format_args(argument.unsignedValue));
+            case Kind::Float:
+                return std::vformat_to(context.out(), spec, std::make_format_args(argument.floatValue));
+            default: {
+                const std::string_view text(argument.text.data, argument.text.size);
+                return std::vformat_to(context.out(), spec, std::make_format_args(text));
+            }
+        }
+    }
+};
+
+#define APR_LOG_ASYNC(level, ...)                                               \
+    do {                                                                        \
+        if (spdlog::default_logger_raw()->should_log(level)) {                  \
+            Diagnostics::AsyncLog::Write(level, __VA_ARGS__);                   \
+        }                                                                       \
+    } while (false)
+#define APR_TRACE(...) APR_LOG_ASYNC(spdlog::level::trace, __VA_ARGS__)
+#define APR_DEBUG(...) APR_LOG_ASYNC(spdlog::level::debug, __VA_ARGS__)
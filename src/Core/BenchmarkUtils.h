@@ -0,0 +1,62 @@
+#pragma once
+
+// Shared by the plugin's benchmark and CorePerf, so that timings from the game and from the core alone are made the
+// same way and can be compared
+
+namespace Diagnostics {
+    // Fixed seed, so that every run measures the same rules and potions
+    class Random {
+    private:
+        std::uint64_t state;
+
+    public:
+        explicit Random(std::uint64_t seed) : state(seed) {}
+
+        std::uint32_t Next(std::uint32_t bound) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return static_cast<std::uint32_t>(state >> 33) % bound;
+        }
+
+        float NextFloat(float min, float max) { return min + (max - min) * (Next(1 << 24) / float(1 << 24)); }
+    };
+
+    // Keeps results alive so the measured work cannot be optimized away
+    inline volatile std::uintptr_t sink = 0;
+
+    template <class Function>
+    double MeasureNanosecondsPerOperation(Function&& function, std::int64_t operations) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / operations;
+    }
+
+    // Fills picked with count values from pool, none of them repeated. The pool must hold at least count values.
+    template <class Value>
+    void PickDistinct(Random& random, std::span<const Value> pool, int count, Value picked[]) {
+        for (int i = 0; i < count; i++) {
+            do {
+                picked[i] = pool[random.Next(static_cast<std::uint32_t>(pool.size()))];
+            } while (std::find(picked, picked + i, picked[i]) != picked + i);
+        }
+    }
+
+    // A rule file for timing the parser, with three effects per potion drawn from effectIDs. Effects are written as
+    // "Plugin.esp|FormID", but only parsing is measured, so they are never looked up.
+    inline std::string MakeRuleFileJson(Random& random, std::span<const std::uint32_t> effectIDs, int potionsPerFile) {
+        std::string json = "{\n  \"effectPotencies\": {},\n  \"potions\": [\n";
+        for (int i = 0; i < potionsPerFile; i++) {
+            json += std::format(
+                "    {{\n      \"name\": \"{{}}Benchmark Potion {}\",\n      \"descriptor\": \"potion\",\n"
+                "      \"effects\": [",
+                i);
+            for (int j = 0; j < 3; j++) {
+                const auto effectID = effectIDs[random.Next(static_cast<std::uint32_t>(effectIDs.size()))];
+                json += std::format("{}\"Skyrim.esm|{:X}\"", j > 0 ? ", " : "", effectID & 0xFFFFFF);
+            }
+            json += i + 1 < potionsPerFile ? "]\n    },\n" : "]\n    }\n";
+        }
+        json += "  ]\n}\n";
+        return json;
+    }
+}
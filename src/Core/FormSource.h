@@ -0,0 +1,21 @@
+#pragma once
+
+#include "RuleTypes.h"
+
+namespace Settings {
+    // How the rules reach the forms they name. The plugin resolves identifiers through the game's data handler;
+    // anything else can supply forms of its own.
+    class FormSource {
+    public:
+        virtual ~FormSource() = default;
+
+        // Queues an identifier, either "Plugin.esp|BEEF0" or an editor ID. It must outlive the source.
+        virtual void Add(std::string_view identifier) = 0;
+
+        // Looks up every queued identifier
+        virtual void Resolve() = 0;
+
+        // Returns the formID of the magic effect an identifier passed to Add names, or why it does not name one
+        virtual std::expected<FormID, std::string> FindEffect(std::string_view identifier) const = 0;
+    };
+}
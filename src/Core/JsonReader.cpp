@@ -0,0 +1,329 @@
+#include "JsonReader.h"
+
+namespace Settings {
+    JsonReader::JsonReader(std::istream& p_stream, std::string_view p_sourceName)
+        : stream(p_stream.rdbuf()), sourceName(p_sourceName) {
+        // Some editors on Windows save UTF-8 with a byte order mark. It is invisible there, so it does not count
+        // towards the column either.
+        if (stream->sgetc() == 0xEF) {
+            stream->sbumpc();
+            if (stream->sbumpc() != 0xBB || stream->sbumpc() != 0xBF) {
+                Fail("Invalid byte order mark");
+            }
+        }
+    }
+
+    std::string JsonReader::GetLocation() const {
+        return sourceName + ":" + std::to_string(line) + ":" + std::to_string(column);
+    }
+
+    void JsonReader::Fail(std::string_view message) const {
+        throw ParseError(GetLocation() + ": " + std::string(message));
+    }
+
+    int JsonReader::Peek() { return stream->sgetc(); }
+
+    int JsonReader::Get() {
+        const int c = stream->sbumpc();
+        if (c == '\n') {
+            line++;
+            column = 1;
+        } else if (c != std::char_traits<char>::eof()) {
+            column++;
+        }
+        return c;
+    }
+
+    void JsonReader::Expect(char expected) {
+        if (Get() != expected) {
+            Fail(std::string("Expected '") + expected + "'");
+        }
+    }
+
+    void JsonReader::Expect(std::string_view literal) {
+        for (const char c : literal) {
+            if (Get() != c) {
+                Fail(std::string("Expected \"") + std::string(literal) + "\"");
+            }
+        }
+    }
+
+    void JsonReader::SkipWhitespace() {
+        while (true) {
+            const int c = Peek();
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                Get();
+            } else if (c == '/') {
+                SkipComment();
+            } else {
+                return;
+            }
+        }
+    }
+
+    void JsonReader::SkipComment() {
+        // Comments are not standard JSON, but have always been accepted in these files
+        Get();
+        const int style = Get();
+        if (style == '/') {
+            for (int c = Peek(); c != '\n' && c != std::char_traits<char>::eof(); c = Peek()) {
+                Get();
+            }
+        } else if (style == '*') {
+            for (int c = Get(); !(c == '*' && Peek() == '/'); c = Get()) {
+                if (c == std::char_traits<char>::eof()) {
+                    Fail("Unterminated comment");
+                }
+            }
+            Get();
+        } else {
+            Fail("Unexpected character");
+        }
+    }
+
+    JsonReader::Type JsonReader::PeekType() {
+        SkipWhitespace();
+        switch (Peek()) {
+            case 'n':
+                return Type::Null;
+            case 't':
+            case 'f':
+                return Type::Bool;
+            case '"':
+                return Type::String;
+            case '[':
+                return Type::Array;
+            case '{':
+                return Type::Object;
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+                return Type::Number;
+            case std::char_traits<char>::eof():
+                return Type::End;
+            default:
+                Fail("Unexpected character");
+        }
+    }
+
+    void JsonReader::BeginObject() {
+        SkipWhitespace();
+        Expect('{');
+        containerHasValue.push_back(false);
+    }
+
+    void JsonReader::BeginArray() {
+        SkipWhitespace();
+        Expect('[');
+        containerHasValue.push_back(false);
+    }
+
+    bool JsonReader::NextInContainer(char close) {
+        SkipWhitespace();
+        if (Peek() == close) {
+            Get();
+            containerHasValue.pop_back();
+            return false;
+        }
+        if (containerHasValue.back()) {
+            Expect(',');
+            SkipWhitespace();
+
+            // Trailing commas are not standard JSON either, but are easy to leave behind when editing by hand
+            if (Peek() == close) {
+                Get();
+                containerHasValue.pop_back();
+                return false;
+            }
+        }
+        containerHasValue.back() = true;
+        return true;
+    }
+
+    bool JsonReader::NextMember(std::string& key) {
+        if (!NextInContainer('}')) {
+            return false;
+        }
+        if (Peek() != '"') {
+            Fail("Expected a member name");
+        }
+        key = ReadString();
+        SkipWhitespace();
+        Expect(':');
+        return true;
+    }
+
+    bool JsonReader::NextElement() { return NextInContainer(']'); }
+
+    std::string JsonReader::ReadString() {
+        SkipWhitespace();
+        Expect('"');
+        std::string output;
+        while (true) {
+            const int c = Get();
+            if (c == '"') {
+                return output;
+            } else if (c == std::char_traits<char>::eof() || c == '\n') {
+                Fail("Unterminated string");
+            } else if (c != '\\') {
+                output.push_back(static_cast<char>(c));
+                continue;
+            }
+
+            switch (Get()) {
+                case '"':
+                    output.push_back('"');
+                    break;
+                case '\\':
+                    output.push_back('\\');
+                    break;
+                case '/':
+                    output.push_back('/');
+                    break;
+                case 'b':
+                    output.push_back('\b');
+                    break;
+                case 'f':
+                    output.push_back('\f');
+                    break;
+                case 'n':
+                    output.push_back('\n');
+                    break;
+                case 'r':
+                    output.push_back('\r');
+                    break;
+                case 't':
+                    output.push_back('\t');
+                    break;
+                case 'u': {
+                    std::uint32_t codePoint = ReadHex4();
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {  // High surrogate, a low one must follow
+                        Expect("\\u");
+                        const std::uint32_t low = ReadHex4();
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            Fail("Invalid surrogate pair");
+                        }
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(output, codePoint);
+                } break;
+                default:
+                    Fail("Invalid escape sequence");
+            }
+        }
+    }
+
+    std::uint32_t JsonReader::ReadHex4() {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            const int c = Get();
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                Fail("Invalid \\u escape");
+            }
+        }
+        return value;
+    }
+
+    void JsonReader::AppendUtf8(std::string& output, std::uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            output.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    double JsonReader::ReadNumber() {
+        SkipWhitespace();
+        // Numbers are short, so gather the characters that can make one up and let from_chars validate them
+        char buffer[64];
+        std::size_t length = 0;
+        for (int c = Peek(); (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+             c = Peek()) {
+            if (length == sizeof(buffer)) {
+                Fail("Number is too long");
+            }
+            buffer[length++] = static_cast<char>(Get());
+        }
+
+        double value = 0.0;
+        const auto [end, error] = std::from_chars(buffer, buffer + length, value);
+        if (length == 0 || error != std::errc() || end != buffer + length) {
+            Fail("Invalid number");
+        }
+        return value;
+    }
+
+    bool JsonReader::ReadBool() {
+        SkipWhitespace();
+        if (Peek() == 't') {
+            Expect("true"sv);
+            return true;
+        }
+        Expect("false"sv);
+        return false;
+    }
+
+    void JsonReader::Skip() {
+        std::string key;
+        switch (PeekType()) {
+            case Type::Null:
+                Expect("null"sv);
+                break;
+            case Type::Bool:
+                ReadBool();
+                break;
+            case Type::Number:
+                ReadNumber();
+                break;
+            case Type::String:
+                ReadString();
+                break;
+            case Type::Array:
+                BeginArray();
+                while (NextElement()) {
+                    Skip();
+                }
+                break;
+            case Type::Object:
+                BeginObject();
+                while (NextMember(key)) {
+                    Skip();
+                }
+                break;
+            case Type::End:
+                Fail("Unexpected end of file");
+        }
+    }
+
+    void JsonReader::ExpectEnd() {
+        SkipWhitespace();
+        if (Peek() != std::char_traits<char>::eof()) {
+            Fail("Unexpected content after the end of the document");
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+namespace Settings {
+    // Single-pass JSON reader that pulls values straight from a stream instead of building a document,
+    // and keeps track of the line and column being read so that errors can point at the problem.
+    class JsonReader {
+    public:
+        enum class Type {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object,
+            End
+        };
+
+        class ParseError : public std::runtime_error {
+        public:
+            using std::runtime_error::runtime_error;
+        };
+
+        JsonReader(std::istream& p_stream, std::string_view p_sourceName);
+
+        // "File.json:line:column" of the next character to be read
+        std::string GetLocation() const;
+
+        // Type of the next value, without consuming it
+        Type PeekType();
+
+        // Objects and arrays are read by calling Begin, then Next until it returns false
+        void BeginObject();
+        bool NextMember(std::string& key);
+        void BeginArray();
+        bool NextElement();
+
+        std::string ReadString();
+        double ReadNumber();
+        bool ReadBool();
+
+        // Consumes the next value, whatever its type
+        void Skip();
+
+        // Checks that nothing but whitespace is left
+        void ExpectEnd();
+
+        [[noreturn]] void Fail(std::string_view message) const;
+
+    private:
+        std::streambuf* stream;
+        std::string sourceName;
+        int line = 1;
+        int column = 1;
+
+        // Whether the innermost open object or array has had a value yet, to know whether a comma is expected
+        std::vector<bool> containerHasValue = {};
+
+        int Peek();
+        int Get();
+        void Expect(char expected);
+        void Expect(std::string_view literal);
+        void SkipWhitespace();
+        void SkipComment();
+        bool NextInContainer(char close);
+        void AppendUtf8(std::string& output, std::uint32_t codePoint);
+        std::uint32_t ReadHex4();
+    };
+}
@@ -0,0 +1,27 @@
+#include "NameFormat.h"
+
+namespace Settings {
+    DescriptorFormat NameFormat::GetDescriptorFormat(std::string_view name) {
+        if (name.starts_with('{')) {
+            return After;
+        } else if (name.ends_with('}')) {
+            return Before;
+        }
+        return Both;
+    }
+
+    std::string NameFormat::FormatName(std::string_view inputName, DescriptorFormat format,
+                                       std::string_view descriptor) {
+        std::string spacedDescriptor;
+        if (descriptor.empty()) {
+            spacedDescriptor = format == Both ? " " : "";
+        } else if (format == Before) {
+            spacedDescriptor = std::format(" {}", descriptor);
+        } else if (format == After) {
+            spacedDescriptor = std::format("{} ", descriptor);
+        } else {
+            spacedDescriptor = std::format(" {} ", descriptor);
+        }
+        return std::vformat(inputName, std::make_format_args(spacedDescriptor));
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "RuleTypes.h"
+
+namespace Settings {
+    // Places descriptors and numerals into potion names
+    class NameFormat {
+    public:
+        static constexpr const char* ROMAN_NUMERALS[] = {"I",    "II",  "III",  "IV",    "V",   "VI",   "VII",
+                                                         "VIII", "IX",  "X",    "XI",    "XII", "XIII", "XIV",
+                                                         "XV",   "XVI", "XVII", "XVIII", "XIX", "XX"};
+
+        NameFormat() = delete;
+
+        // Where the descriptor goes in a name, from the position of its '{}'
+        static DescriptorFormat GetDescriptorFormat(std::string_view name);
+
+        // Fills a name's '{}' with a descriptor, spaced for where it is placed
+        static std::string FormatName(std::string_view inputName, DescriptorFormat format, std::string_view descriptor);
+    };
+}
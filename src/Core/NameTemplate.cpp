@@ -0,0 +1,88 @@
+#include "NameTemplate.h"
+
+namespace Settings {
+    namespace {
+        // A "{noun2}" or "{adjective1}" placeholder
+        struct Placeholder {
+            bool noun;
+            int position;  // 1 is the costliest effect
+        };
+
+        std::optional<Placeholder> ParsePlaceholder(std::string_view text) {
+            Placeholder placeholder = {};
+            if (text.starts_with("noun")) {
+                placeholder.noun = true;
+                text.remove_prefix(4);
+            } else if (text.starts_with("adjective")) {
+                placeholder.noun = false;
+                text.remove_prefix(9);
+            } else {
+                return std::nullopt;
+            }
+            const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), placeholder.position);
+            if (error != std::errc() || end != text.data() + text.size()) {
+                return std::nullopt;
+            }
+            return placeholder;
+        }
+    }
+
+    std::string NameTemplate::Expand(std::string_view nameTemplate, std::span<const FormID> orderedIDs,
+                                     const FragmentMap& fragments) {
+        std::string name;
+        std::size_t next = 0;
+        while (next < nameTemplate.size()) {
+            const auto open = nameTemplate.find('{', next);
+            name += nameTemplate.substr(next, open - next);
+            if (open == std::string_view::npos) {
+                break;
+            }
+            const auto close = nameTemplate.find('}', open);
+            const auto placeholder = ParsePlaceholder(nameTemplate.substr(open + 1, close - open - 1));
+            if (!placeholder) {
+                name += "{}";  // The descriptor, placed when the names are rendered
+            } else {
+                const auto fragment = fragments.find(orderedIDs[placeholder->position - 1]);
+                if (fragment == fragments.end()) {
+                    return {};
+                }
+                // A fragment may define only a noun or only an adjective, and is then of no use for the other
+                const auto& part = placeholder->noun ? fragment->second.noun : fragment->second.adjective;
+                if (part.empty()) {
+                    return {};
+                }
+                name += part;
+            }
+            next = close + 1;
+        }
+        return name;
+    }
+
+    std::optional<std::string> NameTemplate::Validate(std::string_view nameTemplate, int effectCount) {
+        constexpr auto UNBALANCED = "it must contain 1 or fewer '{}' and no unbalanced braces";
+        if (std::ranges::count(nameTemplate, '{') != std::ranges::count(nameTemplate, '}')) {
+            return UNBALANCED;
+        }
+
+        int descriptors = 0;
+        for (auto open = nameTemplate.find('{'); open != std::string_view::npos;
+             open = nameTemplate.find('{', open + 1)) {
+            const auto close = nameTemplate.find('}', open);
+            if (close == std::string_view::npos || nameTemplate.find('{', open + 1) < close) {
+                return UNBALANCED;
+            }
+            const auto text = nameTemplate.substr(open + 1, close - open - 1);
+            if (text.empty()) {
+                if (++descriptors > 1) {
+                    return UNBALANCED;
+                }
+            } else if (const auto placeholder = ParsePlaceholder(text); !placeholder) {
+                return std::format("\"{{{}}}\" is not a placeholder", text);
+            } else if (placeholder->position < 1 || placeholder->position > effectCount) {
+                return std::format("\"{{{}}}\" refers to an effect a {}-effect potion does not have", text,
+                                   effectCount);
+            }
+        }
+        return std::nullopt;
+    }
+}
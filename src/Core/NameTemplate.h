@@ -0,0 +1,28 @@
+#pragma once
+
+#include "RuleTypes.h"
+
+namespace Settings {
+    // Templates such as "{}{noun1} of {adjective2}", which name a potion from fragments of its effects. 1 is the
+    // costliest effect, and '{}' is left for the descriptor.
+    class NameTemplate {
+    public:
+        struct Fragment {
+            std::string noun;
+            std::string adjective;
+        };
+
+        using FragmentMap = std::unordered_map<FormID, Fragment>;
+
+        NameTemplate() = delete;
+
+        // Fills a template's placeholders with the fragments of the given effects, leaving {} for the descriptor.
+        // Returns an empty string if an effect has no fragment, or not the noun or adjective the template needs. The
+        // template must have been validated.
+        static std::string Expand(std::string_view nameTemplate, std::span<const FormID> orderedIDs,
+                                  const FragmentMap& fragments);
+
+        // Returns an error if a template has placeholders that cannot be filled for this many effects
+        static std::optional<std::string> Validate(std::string_view nameTemplate, int effectCount);
+    };
+}
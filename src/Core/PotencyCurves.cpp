@@ -0,0 +1,29 @@
+#include "PotencyCurves.h"
+
+namespace Settings {
+    float PotencyCurves::Evaluate(const PotencyDefinition& definition, float fraction) {
+        switch (definition.curve) {
+            case PotencyCurve::Log:
+                // Rises quickly at first, then levels off
+                return std::log1p(9.0f * fraction) / std::log(10.0f);
+            case PotencyCurve::Power:
+                return std::pow(fraction, definition.exponent);
+            case PotencyCurve::Points: {
+                const auto& points = definition.points;
+                const auto next = std::upper_bound(points.begin(), points.end(), fraction,
+                                                   [](float value, const auto& point) { return value < point.first; });
+                if (next == points.begin()) {
+                    return points.front().second;
+                }
+                if (next == points.end()) {
+                    return points.back().second;
+                }
+                const auto& previous = *(next - 1);
+                const float t = (fraction - previous.first) / (next->first - previous.first);
+                return previous.second + t * (next->second - previous.second);
+            }
+            default:
+                return fraction;
+        }
+    }
+}
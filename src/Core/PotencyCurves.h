@@ -0,0 +1,17 @@
+#pragma once
+
+#include "RuleTypes.h"
+
+namespace Settings {
+    // Non-linear potency curves, which are baked into lookup tables when the rules are built
+    class PotencyCurves {
+    public:
+        // Entries in the lookup table that each non-linear curve is baked into
+        static const int RESOLUTION = 128;
+
+        PotencyCurves() = delete;
+
+        // Potency at a fraction of the way from an effect's min to its max, both between 0 and 1
+        static float Evaluate(const PotencyDefinition& definition, float fraction);
+    };
+}
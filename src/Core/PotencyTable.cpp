@@ -0,0 +1,87 @@
+#include "PotencyTable.h"
+
+#include "AsyncLog.h"
+
+namespace Settings {
+    void PotencyTable::Add(FormID effectID, const PotencyDefinition& definition, PotencyDriver driver) {
+        auto& record = records.emplace_back(effectID, definition.min, 1.0f / (definition.max - definition.min), driver);
+
+        // Curves are baked into lookup tables, shared by every effect resolved from the same entry
+        if (definition.curve != PotencyCurve::Linear) {
+            const auto [curve, inserted] = curveOffsets.emplace(&definition, (int)curveTables.size());
+            if (inserted) {
+                for (int i = 0; i < CURVE_RESOLUTION; i++) {
+                    const float fraction = (float)i / (CURVE_RESOLUTION - 1);
+                    curveTables.push_back(PotencyCurves::Evaluate(definition, fraction));
+                }
+            }
+            record.curveOffset = curve->second;
+        }
+    }
+
+    void PotencyTable::Sort() {
+        std::sort(records.begin(), records.end(),
+                  [](const PotencyRecord& a, const PotencyRecord& b) { return a.effectID < b.effectID; });
+        curveOffsets.clear();
+    }
+
+    const PotencyRecord* PotencyTable::Find(FormID effectID) const {
+        const auto it = std::lower_bound(records.begin(), records.end(), effectID,
+                                         [](const PotencyRecord& record, FormID id) { return record.effectID < id; });
+        return (it != records.end() && it->effectID == effectID) ? &*it : nullptr;
+    }
+
+    float PotencyTable::Estimate(std::span<const CraftedEffect> effects, const CraftedEffect& costliestEffect) const {
+        if (aggregation == PotencyAggregation::Costliest) {
+            return EstimateEffect(costliestEffect);
+        }
+
+        float potencies[MAX_EFFECTS] = {};
+        float weights[MAX_EFFECTS] = {};
+        const int effectCount = std::min<int>(static_cast<int>(effects.size()), MAX_EFFECTS);
+        for (int i = 0; i < effectCount; i++) {
+            potencies[i] = EstimateEffect(effects[i]);
+            weights[i] = effects[i].cost;
+        }
+
+        if (aggregation == PotencyAggregation::Max) {
+            return *std::max_element(potencies, potencies + effectCount);
+        }
+        const float totalWeight = std::accumulate(weights, weights + effectCount, 0.0f);
+        if (totalWeight <= 0.0f) {
+            return std::accumulate(potencies, potencies + effectCount, 0.0f) / effectCount;
+        }
+        return std::inner_product(potencies, potencies + effectCount, weights, 0.0f) / totalWeight;
+    }
+
+    float PotencyTable::EstimateEffect(const CraftedEffect& effect) const {
+        PotencyRecord record;
+        if (const auto found = Find(effect.effectID)) {
+            record = *found;
+        } else {
+            // Missing entries are warned about once when the rules are built, so this only traces them
+            APR_DEBUG("Did not find potency entry for {:08X}", effect.effectID);
+            record = {effect.effectID, DEFAULT_MIN_POTENCY, DEFAULT_INVERSE_RANGE, effect.driver};
+        }
+
+        float value;
+        switch (record.driver) {
+            case PotencyDriver::Magnitude:
+                value = effect.magnitude;
+                break;
+            case PotencyDriver::Duration:
+                value = static_cast<float>(effect.duration);
+                break;
+            default:
+                APR_TRACE("Neither magnitude nor duration are affected by power - defaulting to 0.5 potency");
+                return 0.5f;
+        }
+
+        const float fraction = std::clamp((value - record.min) * record.inverseRange, 0.0f, 1.0f);
+        if (record.curveOffset < 0) {
+            return fraction;
+        }
+        const int step = static_cast<int>(fraction * (CURVE_RESOLUTION - 1) + 0.5f);
+        return curveTables[record.curveOffset + step];
+    }
+}
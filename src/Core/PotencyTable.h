@@ -0,0 +1,88 @@
+#pragma once
+
+#include "PotencyCurves.h"
+#include "RuleTypes.h"
+
+namespace Settings {
+    // How the potencies of a potion's effects are combined into the potency of the potion
+    enum class PotencyAggregation : std::uint8_t {
+        Costliest,  // Only the costliest effect counts
+        Max,
+        WeightedMean  // Weighted by the cost of each effect
+    };
+
+    // Which aspect of an effect scales with alchemy skill
+    enum class PotencyDriver : std::uint8_t {
+        Magnitude,
+        Duration,
+        None
+    };
+
+    // An effect of a crafted item, copied out of the game's so that it can be estimated anywhere
+    struct CraftedEffect {
+        FormID effectID = 0;
+        float magnitude = 0.0f;
+        std::uint32_t duration = 0;
+        float cost = 0.0f;
+
+        // From the magic effect's flags, used when no potency is defined for it
+        PotencyDriver driver = PotencyDriver::None;
+    };
+
+    // Potency range of one magic effect, resolved when the rules are built
+    struct PotencyRecord {
+        FormID effectID = 0;
+        float min = 0.0f;
+        float inverseRange = 0.0f;
+        PotencyDriver driver = PotencyDriver::None;
+
+        // Start of this effect's curve in PotencyTable::curveTables, or -1 if it is linear
+        std::int32_t curveOffset = -1;
+    };
+
+    // Potency ranges of every magic effect that has one, and how crafted items are placed within them
+    class PotencyTable {
+    public:
+        static const int DEFAULT_MIN_POTENCY = 5;
+        static const int DEFAULT_MAX_POTENCY = 100;
+
+        // Entries in the lookup table that each non-linear curve is baked into
+        static const int CURVE_RESOLUTION = PotencyCurves::RESOLUTION;
+
+        // Sorted by effectID once Sort has been called
+        std::pmr::vector<PotencyRecord> records;
+
+        // CURVE_RESOLUTION potencies per non-linear curve, evenly spaced from min to max
+        std::pmr::vector<float> curveTables;
+
+        PotencyAggregation aggregation = PotencyAggregation::Costliest;
+
+        explicit PotencyTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : records(resource), curveTables(resource) {}
+
+        // Adds an effect's range. Effects resolved from the same definition share its curve.
+        void Add(FormID effectID, const PotencyDefinition& definition, PotencyDriver driver);
+
+        // Orders the records for Find once every effect has been added
+        void Sort();
+
+        // Returns the potency range defined for a magic effect, or nullptr if there is none
+        const PotencyRecord* Find(FormID effectID) const;
+
+        // Potency of a crafted item between 0 and 1, combining its effects as set by aggregation
+        float Estimate(std::span<const CraftedEffect> effects, const CraftedEffect& costliestEffect) const;
+
+        float EstimateEffect(const CraftedEffect& effect) const;
+
+        // The game's spell cost formula
+        static float GetEffectCost(float baseCost, float magnitude, std::uint32_t duration) {
+            return baseCost * std::pow(std::max(magnitude, 1.0f) * std::max(duration / 10.0f, 1.0f), 1.1f);
+        }
+
+    private:
+        static constexpr float DEFAULT_INVERSE_RANGE = 1.0f / (DEFAULT_MAX_POTENCY - DEFAULT_MIN_POTENCY);
+
+        // Offset of each definition's curve while the table is being filled
+        std::map<const PotencyDefinition*, int> curveOffsets;
+    };
+}
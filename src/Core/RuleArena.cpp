@@ -0,0 +1,29 @@
+#include "RuleArena.h"
+
+namespace Settings {
+    void* CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        void* pointer = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        allocatedBytes += bytes;
+        blockCount++;
+        return pointer;
+    }
+
+    void CountingResource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        allocatedBytes -= bytes;
+        blockCount--;
+    }
+
+    std::string_view StringPool::Intern(std::string_view string) {
+        if (string.empty()) {
+            return {};
+        }
+        if (const auto it = strings.find(string); it != strings.end()) {
+            return *it;
+        }
+
+        const auto data = static_cast<char*>(resource->allocate(string.size(), alignof(char)));
+        std::copy(string.begin(), string.end(), data);
+        return *strings.emplace(data, string.size()).first;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace Settings {
+    // Passes allocations through to the heap, keeping count of how much is held
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        std::size_t GetAllocatedBytes() const { return allocatedBytes; }
+
+        std::size_t GetBlockCount() const { return blockCount; }
+
+    private:
+        std::size_t allocatedBytes = 0;
+        std::size_t blockCount = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Stores each distinct string once. Strings live as long as the memory resource they were allocated from.
+    class StringPool {
+    public:
+        explicit StringPool(std::pmr::memory_resource* p_resource) : resource(p_resource), strings(p_resource) {}
+
+        std::string_view Intern(std::string_view string);
+
+        std::size_t size() const { return strings.size(); }
+
+    private:
+        std::pmr::memory_resource* resource;
+        std::pmr::unordered_set<std::string_view> strings;
+    };
+}
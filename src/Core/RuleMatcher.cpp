@@ -0,0 +1,101 @@
+#include "RuleMatcher.h"
+
+namespace Settings {
+    void RuleMatcher::Build(std::size_t count, const std::function<const Rule&(std::size_t)>& getRule) {
+        exactRules.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            const auto& rule = getRule(i);
+            const int index = static_cast<int>(i);
+            if (rule.match != MatchMode::Exactly) {
+                patternRules.push_back({index, rule.priority, rule.match, rule.kind});
+                continue;
+            }
+
+            // The first rule loaded with a signature wins, unless a later one has a higher priority
+            const auto [it, inserted] = exactRules.emplace(
+                EffectSignature(rule.effectIDs, rule.effectCount, rule.kind), ExactRule{index, rule.priority});
+            if (!inserted) {
+                auto& chosen = it->second;
+                int unused = index;
+                if (rule.priority > chosen.priority) {
+                    unused = std::exchange(chosen, ExactRule{index, rule.priority}).index;
+                }
+                logger::warn("\"{}\" has the same effects as \"{}\" and will never be used", getRule(unused).name,
+                             getRule(chosen.index).name);
+            }
+        }
+        logger::info("Indexed {} unique effect combinations", exactRules.size());
+
+        std::stable_sort(patternRules.begin(), patternRules.end(),
+                         [](const PatternRule& a, const PatternRule& b) { return a.priority > b.priority; });
+
+        // Give each effect named by a pattern rule its own bit
+        for (const auto& patternRule : patternRules) {
+            const auto& rule = getRule(patternRule.index);
+            for (int i = 0; i < rule.effectCount; i++) {
+                effectBits.try_emplace(rule.effectIDs[i], static_cast<std::uint32_t>(effectBits.size()));
+            }
+        }
+        maskWords = static_cast<int>((effectBits.size() + 63) / 64);
+
+        patternMasks.assign(patternRules.size() * maskWords, 0);
+        for (std::size_t i = 0; i < patternRules.size(); i++) {
+            const auto& rule = getRule(patternRules[i].index);
+            const auto mask = patternMasks.data() + i * maskWords;
+            for (int j = 0; j < rule.effectCount; j++) {
+                const auto bit = effectBits.at(rule.effectIDs[j]);
+                mask[bit / 64] |= 1ull << (bit % 64);
+            }
+            for (int word = 0; word < maskWords; word++) {
+                patternRules[i].effectCount += std::popcount(mask[word]);
+            }
+        }
+        logger::info("Built {} \"all\"/\"any\" rules over {} effects", patternRules.size(), effectBits.size());
+    }
+
+    int RuleMatcher::Find(const EffectSignature& signature) const {
+        const auto it = exactRules.find(signature);
+        const ExactRule* exact = it != exactRules.end() ? &it->second : nullptr;
+        const int exactIndex = exact ? exact->index : -1;
+        if (patternRules.empty()) {
+            return exactIndex;
+        }
+
+        // Bits of the potion's distinct effects. A potion has at most MAX_EFFECTS, so each rule is tested by looking
+        // them up in its mask rather than by building a mask of the potion, and nothing is allocated.
+        std::uint32_t craftedBits[MAX_EFFECTS];
+        int craftedCount = 0;
+        for (int i = 0; i < signature.effectCount; i++) {
+            const auto bit = effectBits.find(signature.effectIDs[i]);
+            if (bit != effectBits.end() && std::find(craftedBits, craftedBits + craftedCount, bit->second) ==
+                                               craftedBits + craftedCount) {
+                craftedBits[craftedCount++] = bit->second;
+            }
+        }
+        if (craftedCount == 0) {
+            return exactIndex;
+        }
+
+        // Rules are in priority order, so the scan can stop at the first match, or once an exact match would win
+        for (std::size_t i = 0; i < patternRules.size(); i++) {
+            const auto& patternRule = patternRules[i];
+            if (exact && patternRule.priority <= exact->priority) {
+                break;
+            }
+            if (patternRule.kind != signature.kind || (patternRule.match == MatchMode::All &&
+                                                       patternRule.effectCount > craftedCount)) {
+                continue;
+            }
+
+            const auto mask = patternMasks.data() + i * maskWords;
+            int shared = 0;
+            for (int j = 0; j < craftedCount; j++) {
+                shared += (mask[craftedBits[j] / 64] >> (craftedBits[j] % 64)) & 1;
+            }
+            if (patternRule.match == MatchMode::All ? shared == patternRule.effectCount : shared > 0) {
+                return patternRule.index;
+            }
+        }
+        return exactIndex;
+    }
+}
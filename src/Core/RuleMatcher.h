@@ -0,0 +1,76 @@
+#pragma once
+
+#include "RuleTypes.h"
+
+namespace Settings {
+    // A rule as matching sees it, once its effects have been looked up. The plugin's potions extend it with how
+    // they are named.
+    struct Rule {
+        FormID effectIDs[MAX_RULE_EFFECTS] = {};
+
+        // Interned in the rule set's string pool
+        std::string_view name;
+        int effectCount = 0;
+        MatchMode match = MatchMode::Exactly;
+
+        // When several rules match, the highest priority wins
+        int priority = 0;
+
+        ItemKind kind = ItemKind::Potion;
+    };
+
+    // Finds the rule matching a set of effects: "exactly" rules through a hash of their signatures, "all" and "any"
+    // rules through bitmasks over the effects they name. Never modified once built, so it can be read from any thread.
+    class RuleMatcher {
+    public:
+        explicit RuleMatcher(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : exactRules(resource), effectBits(resource), patternRules(resource), patternMasks(resource) {}
+
+        // Indexes rules in load order. A rule is identified by its position, which Find returns.
+        template <std::derived_from<Rule> R>
+        void Build(std::span<const R> rules) {
+            Build(rules.size(), [rules](std::size_t i) -> const Rule& { return rules[i]; });
+        }
+
+        // Returns the index of the highest priority rule matching the given effects, or -1 if there is none.
+        // Ties go to "exactly" rules, then to the rule loaded first.
+        int Find(const EffectSignature& signature) const;
+
+        std::size_t GetExactCount() const { return exactRules.size(); }
+
+        std::size_t GetPatternCount() const { return patternRules.size(); }
+
+    private:
+        struct ExactRule {
+            int index;
+            int priority;
+        };
+
+        // An "all" or "any" rule, whose effects are stored as a bitmask over effectBits
+        struct PatternRule {
+            int index = 0;
+            int priority = 0;
+            MatchMode match = MatchMode::All;
+            ItemKind kind = ItemKind::Potion;
+
+            // Distinct effects set in the mask, which an "all" rule must find every one of
+            int effectCount = 0;
+        };
+
+        std::pmr::unordered_map<EffectSignature, ExactRule, EffectSignatureHash> exactRules;
+
+        // Dense bit index of every effect named by an "all" or "any" rule
+        std::pmr::unordered_map<FormID, std::uint32_t> effectBits;
+
+        // 64-bit words in each pattern mask
+        int maskWords = 0;
+
+        // Sorted from highest to lowest priority, then in load order
+        std::pmr::vector<PatternRule> patternRules;
+
+        // maskWords words per pattern rule, in the same order
+        std::pmr::vector<std::uint64_t> patternMasks;
+
+        void Build(std::size_t count, const std::function<const Rule&(std::size_t)>& getRule);
+    };
+}
@@ -0,0 +1,455 @@
+#include "RuleParser.h"
+
+#include "AsyncLog.h"
+#include "JsonReader.h"
+#include "NameFormat.h"
+#include "NameTemplate.h"
+
+namespace Settings {
+    std::optional<int> RuleParser::ReadInt(JsonReader& reader, std::string_view option) {
+        const auto location = reader.GetLocation();
+        const double number = reader.ReadNumber();
+
+        // Converting a double that does not fit is undefined, so anything out of range is rejected first
+        if (!(number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max())) {
+            logger::error("{}: \"{}\" must be a whole number from {} to {}", location, option,
+                          std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+            return std::nullopt;
+        }
+        return static_cast<int>(number);
+    }
+
+    void RuleParser::ParsePotionFile(RuleFile& ruleFile) {
+        const auto fileName = ruleFile.path.filename().string();
+        logger::info("Reading {} ...", fileName);
+
+        std::ifstream stream(ruleFile.path, std::ios::binary);
+        if (!stream.is_open()) {
+            logger::error("Failed to open {}", fileName);
+            return;
+        }
+        ParsePotionStream(stream, fileName, ruleFile);
+    }
+
+    void RuleParser::ParsePotionStream(std::istream& stream, const std::string& fileName, RuleFile& ruleFile) {
+        try {
+            JsonReader reader(stream, fileName);
+            bool foundPotions = false;
+            bool foundPotencies = false;
+
+            std::string key;
+            reader.BeginObject();
+            while (reader.NextMember(key)) {
+                if (key == "potions") {
+                    ParsePotions(reader, ruleFile.potions, ItemKind::Potion);
+                    foundPotions = true;
+                } else if (key == "enchantments") {
+                    ParsePotions(reader, ruleFile.potions, ItemKind::Enchantment);
+                    foundPotions = true;
+                } else if (key == "effectPotencies") {
+                    ParsePotencies(reader, ruleFile.potencies);
+                    foundPotencies = true;
+                } else if (key == "descriptors") {
+                    ParseDescriptors(reader, ruleFile.descriptors);
+                } else if (key == "nameGenerator") {
+                    ParseGenerator(reader, ruleFile.generator);
+                } else if (key == "priority" && reader.PeekType() == JsonReader::Type::Number) {
+                    ruleFile.priority = ReadInt(reader, key).value_or(ruleFile.priority);
+                } else {
+                    reader.Skip();
+                }
+            }
+            reader.ExpectEnd();
+
+            if (!foundPotions) {
+                logger::error("Failed to read \"potions\" or \"enchantments\" option in {}", fileName);
+            }
+            if (!foundPotencies) {
+                logger::info("\"effectPotencies\" not found in {}, will use default values", fileName);
+            }
+            ruleFile.parsed = true;
+        } catch (JsonReader::ParseError& e) {
+            logger::error("Json error: {}", e.what());
+        }
+    }
+
+    void RuleParser::ParsePotions(JsonReader& reader, std::vector<PotionDefinition>& potions, ItemKind kind) {
+        if (reader.PeekType() != JsonReader::Type::Array) {
+            logger::error("{}: Failed to read \"{}\" option - expected an array", reader.GetLocation(),
+                          kind == ItemKind::Enchantment ? "enchantments" : "potions");
+            reader.Skip();
+            return;
+        }
+
+        reader.BeginArray();
+        while (reader.NextElement()) {
+            PotionDefinition potion;
+            potion.kind = kind;
+            if (ParsePotion(reader, potion)) {
+                potions.push_back(std::move(potion));
+            }
+        }
+    }
+
+    bool RuleParser::ParsePotion(JsonReader& reader, PotionDefinition& potion) {
+        using Type = JsonReader::Type;
+
+        potion.location = reader.GetLocation();
+        if (reader.PeekType() != Type::Object) {
+            logger::error("{}: Expected a potion definition", potion.location);
+            reader.Skip();
+            return false;
+        }
+
+        bool hasName = false;
+        bool hasEffects = false;
+        bool hasMatch = true;
+        std::string key;
+        reader.BeginObject();
+        while (reader.NextMember(key)) {
+            if (key == "name" && reader.PeekType() == Type::String) {
+                potion.name = reader.ReadString();
+                hasName = true;
+            } else if (key == "effects" && reader.PeekType() == Type::Array) {
+                hasEffects = true;
+                reader.BeginArray();
+                while (reader.NextElement()) {
+                    if (reader.PeekType() == Type::String) {
+                        potion.effects.push_back(reader.ReadString());
+                    } else {
+                        hasEffects = false;
+                        reader.Skip();
+                    }
+                }
+            } else if (key == "descriptor" && reader.PeekType() == Type::String) {
+                potion.descriptor = reader.ReadString();
+            } else if (key == "match" && reader.PeekType() == Type::String) {
+                const auto match = reader.ReadString();
+                if (match == "exactly") {
+                    potion.match = MatchMode::Exactly;
+                } else if (match == "all") {
+                    potion.match = MatchMode::All;
+                } else if (match == "any") {
+                    potion.match = MatchMode::Any;
+                } else {
+                    logger::error("{}: Unknown match \"{}\" - expected \"exactly\", \"all\" or \"any\"",
+                                  potion.location, match);
+                    hasMatch = false;
+                }
+            } else if (key == "priority" && reader.PeekType() == Type::Number) {
+                potion.priority = ReadInt(reader, key).value_or(potion.priority);
+            } else {
+                reader.Skip();
+            }
+        }
+
+        // Read name
+        if (!hasName) {
+            logger::error("{}: Could not read potion name", potion.location);
+            return false;
+        }
+        const auto& name = potion.name;
+        int open = std::count(name.begin(), name.end(), '{');
+        int close = std::count(name.begin(), name.end(), '}');
+        if (open != close || open > 1 || (open > 0 && name.at(name.find('{') + 1) != '}')) {
+            // Check for names that cannot be formatted correctly (and would cause a crash if used)
+            logger::error(
+                "{}: Could not read potion name - name must contain 1 or fewer '{{}}' and no unbalanced braces",
+                potion.location);
+            return false;
+        }
+
+        // Precalculate descriptor formatting
+        potion.format = NameFormat::GetDescriptorFormat(name);
+
+        // Read effects
+        if (!hasEffects) {
+            logger::error("{}: Could not read \"{}\" effects", potion.location, name);
+            return false;
+        }
+        if (!hasMatch) {
+            return false;
+        }
+        const int effectCount = static_cast<int>(potion.effects.size());
+        // Potions with a single effect are never renamed, but most enchantments have one
+        const int minEffects = potion.match == MatchMode::Exactly && potion.kind == ItemKind::Potion ? 2 : 1;
+        const int maxEffects = potion.match == MatchMode::Any ? MAX_RULE_EFFECTS : MAX_EFFECTS;
+        if (effectCount > maxEffects || effectCount < minEffects) {
+            logger::error(
+                "{}: Error loading effects - this potion must have between {} and {} effects, skipping \"{}\"...",
+                potion.location, minEffects, maxEffects, name);
+            return false;
+        }
+
+        if (potion.descriptor.empty()) {
+            logger::warn("{}: \"{}\" was missing \"descriptor\" field, '{{}}' will be removed.", potion.location, name);
+        }
+        return true;
+    }
+
+    void RuleParser::ParsePotencies(JsonReader& reader, PotencyMap& potencyMap) {
+        using Type = JsonReader::Type;
+
+        if (reader.PeekType() != Type::Object) {
+            logger::error("{}: Failed to read \"effectPotencies\" option - expected an object", reader.GetLocation());
+            reader.Skip();
+            return;
+        }
+
+        // Duplicate entries are overwritten
+        std::string potencyName;
+        reader.BeginObject();
+        while (reader.NextMember(potencyName)) {
+            const auto location = reader.GetLocation();
+            if (reader.PeekType() != Type::Object) {
+                logger::warn("{}: \"{}\" did not have min/max values, skipping", location, potencyName);
+                reader.Skip();
+                continue;
+            }
+
+            PotencyDefinition definition;
+            std::optional<float> min;
+            std::optional<float> max;
+            bool numeric = true;
+            std::string curveName = "linear";
+            bool validPoints = true;
+            std::string field;
+            reader.BeginObject();
+            while (reader.NextMember(field)) {
+                if (field == "curve" && reader.PeekType() == Type::String) {
+                    curveName = reader.ReadString();
+                } else if (field == "exponent" && reader.PeekType() == Type::Number) {
+                    definition.exponent = static_cast<float>(reader.ReadNumber());
+                } else if (field == "points") {
+                    validPoints = ParseCurvePoints(reader, definition.points);
+                } else if (field != "min" && field != "max") {
+                    reader.Skip();
+                } else if (reader.PeekType() != Type::Number) {
+                    numeric = false;
+                    (field == "min" ? min : max) = 0.0f;
+                    reader.Skip();
+                } else {
+                    (field == "min" ? min : max) = static_cast<float>(reader.ReadNumber());
+                }
+            }
+
+            if (curveName == "linear") {
+                definition.curve = PotencyCurve::Linear;
+            } else if (curveName == "log") {
+                definition.curve = PotencyCurve::Log;
+            } else if (curveName == "power") {
+                definition.curve = PotencyCurve::Power;
+            } else if (curveName == "points") {
+                definition.curve = PotencyCurve::Points;
+            } else {
+                logger::warn("{}: \"{}\" has unknown curve \"{}\", skipping", location, potencyName, curveName);
+                continue;
+            }
+
+            if (!min || !max) {
+                logger::warn("{}: {} did not have {} field, ignoring", location, potencyName, min ? "max" : "min");
+            } else if (!numeric) {
+                logger::warn("{}: \"{}\" did not have numeric min/max values, skipping", location, potencyName);
+            } else if (*min >= *max) {
+                logger::warn("{}: \"{}\" has a min potency that is not below its max potency, skipping", location,
+                             potencyName);
+            } else if (definition.curve == PotencyCurve::Power && definition.exponent <= 0.0f) {
+                logger::warn("{}: \"{}\" needs a positive \"exponent\" for its power curve, skipping", location,
+                             potencyName);
+            } else if (definition.curve == PotencyCurve::Points && (!validPoints || definition.points.size() < 2)) {
+                logger::warn(
+                    "{}: \"{}\" needs at least two [fraction, potency] \"points\" between 0 and 1, in increasing "
+                    "order, skipping",
+                    location, potencyName);
+            } else {
+                definition.min = *min;
+                definition.max = *max;
+                potencyMap[potencyName] = std::move(definition);
+                logger::info("Loaded \"{}\" with min potency {}, max potency {} and a {} curve", potencyName, *min,
+                             *max, curveName);
+            }
+        }
+    }
+
+    bool RuleParser::ParseCurvePoints(JsonReader& reader, std::vector<std::pair<float, float>>& points) {
+        using Type = JsonReader::Type;
+
+        if (reader.PeekType() != Type::Array) {
+            reader.Skip();
+            return false;
+        }
+
+        bool valid = true;
+        reader.BeginArray();
+        while (reader.NextElement()) {
+            if (reader.PeekType() != Type::Array) {
+                valid = false;
+                reader.Skip();
+                continue;
+            }
+
+            float values[2] = {};
+            int count = 0;
+            reader.BeginArray();
+            while (reader.NextElement()) {
+                if (count < 2 && reader.PeekType() == Type::Number) {
+                    values[count++] = static_cast<float>(reader.ReadNumber());
+                } else {
+                    valid = false;
+                    reader.Skip();
+                }
+            }
+
+            const auto [fraction, potency] = values;
+            if (count != 2 || fraction < 0.0f || fraction > 1.0f || potency < 0.0f || potency > 1.0f ||
+                (!points.empty() && fraction <= points.back().first)) {
+                valid = false;
+            } else {
+                points.emplace_back(fraction, potency);
+            }
+        }
+        return valid;
+    }
+
+    void RuleParser::ParseDescriptors(JsonReader& reader, DescriptorDefinitions& descriptorDefinitions) {
+        using Type = JsonReader::Type;
+
+        APR_TRACE("Reading descriptors...");
+        if (reader.PeekType() != Type::Object) {
+            logger::error("{}: Failed to read \"descriptors\" option - expected an object", reader.GetLocation());
+            reader.Skip();
+            return;
+        }
+
+        std::string categoryName;
+        reader.BeginObject();
+        while (reader.NextMember(categoryName)) {
+            if (reader.PeekType() != Type::Array) {
+                logger::warn("{}: Descriptor category \"{}\" is not an array, ignoring", reader.GetLocation(),
+                             categoryName);
+                reader.Skip();
+                continue;
+            }
+
+            std::vector<std::string> categoryDescriptors = {};
+            reader.BeginArray();
+            while (reader.NextElement()) {
+                if (reader.PeekType() == Type::String) {
+                    categoryDescriptors.push_back(reader.ReadString());
+                } else {
+                    logger::warn("{}: Descriptor in category \"{}\" is not a string, ignoring", reader.GetLocation(),
+                                 categoryName);
+                    reader.Skip();
+                }
+            }
+            descriptorDefinitions.push_back({categoryName, categoryDescriptors});
+        }
+    }
+
+    void RuleParser::ParseGenerator(JsonReader& reader, GeneratorDefinition& generator) {
+        using Type = JsonReader::Type;
+
+        generator.location = reader.GetLocation();
+        if (reader.PeekType() != Type::Object) {
+            logger::error("{}: Failed to read \"nameGenerator\" option - expected an object", generator.location);
+            reader.Skip();
+            return;
+        }
+
+        std::string key;
+        reader.BeginObject();
+        while (reader.NextMember(key)) {
+            if (key == "descriptor" && reader.PeekType() == Type::String) {
+                generator.descriptor = reader.ReadString();
+            } else if (key == "cacheSize" && reader.PeekType() == Type::Number) {
+                if (const auto cacheSize = ReadInt(reader, key)) {
+                    generator.cacheSize = std::max(1, *cacheSize);
+                }
+            } else if (key == "templates" && reader.PeekType() == Type::Object) {
+                // Keyed by the number of effects the template is for
+                std::string count;
+                reader.BeginObject();
+                while (reader.NextMember(count)) {
+                    const auto location = reader.GetLocation();
+                    int effectCount = 0;
+                    const auto [end, error] = std::from_chars(count.data(), count.data() + count.size(), effectCount);
+                    if (error != std::errc() || end != count.data() + count.size() || effectCount < 2 ||
+                        effectCount > MAX_EFFECTS || reader.PeekType() != Type::String) {
+                        logger::error("{}: Template \"{}\" must be a string keyed by an effect count from 2 to {}",
+                                      location, count, MAX_EFFECTS);
+                        reader.Skip();
+                        continue;
+                    }
+                    auto nameTemplate = reader.ReadString();
+                    if (const auto problem = NameTemplate::Validate(nameTemplate, effectCount)) {
+                        logger::error("{}: Could not read template \"{}\" - {}", location, nameTemplate, *problem);
+                        continue;
+                    }
+                    generator.templates[effectCount] = std::move(nameTemplate);
+                }
+            } else if (key == "fragments" && reader.PeekType() == Type::Object) {
+                // Keyed by effect, the same way as a potion's effects
+                GeneratorDefinition::FragmentDefinition fragment;
+                reader.BeginObject();
+                while (reader.NextMember(fragment.effect)) {
+                    const auto location = reader.GetLocation();
+                    if (reader.PeekType() != Type::Object) {
+                        logger::error("{}: Fragments for \"{}\" must be an object", location, fragment.effect);
+                        reader.Skip();
+                        continue;
+                    }
+                    fragment.noun.clear();
+                    fragment.adjective.clear();
+                    std::string part;
+                    reader.BeginObject();
+                    while (reader.NextMember(part)) {
+                        if (part == "noun" && reader.PeekType() == Type::String) {
+                            fragment.noun = reader.ReadString();
+                        } else if (part == "adjective" && reader.PeekType() == Type::String) {
+                            fragment.adjective = reader.ReadString();
+                        } else {
+                            reader.Skip();
+                        }
+                    }
+                    // Fragments are placed into names that are formatted later, so they cannot contain braces
+                    if (fragment.noun.find_first_of("{}") != std::string::npos ||
+                        fragment.adjective.find_first_of("{}") != std::string::npos) {
+                        logger::error("{}: Fragments for \"{}\" cannot contain braces", location, fragment.effect);
+                        continue;
+                    }
+                    generator.fragments.push_back(fragment);
+                }
+            } else {
+                reader.Skip();
+            }
+        }
+    }
+
+    void RuleParser::AddIdentifiers(const std::vector<RuleFile>& ruleFiles, FormSource& forms) {
+        for (const auto& ruleFile : ruleFiles) {
+            for (const auto& potion : ruleFile.potions) {
+                for (const auto& effect : potion.effects) {
+                    forms.Add(effect);
+                }
+            }
+            for (const auto& fragment : ruleFile.generator.fragments) {
+                forms.Add(fragment.effect);
+            }
+        }
+    }
+
+    bool RuleParser::ResolveEffects(const PotionDefinition& potion, const FormSource& forms,
+                                    FormID (&effectIDs)[MAX_RULE_EFFECTS]) {
+        const int effectCount = static_cast<int>(potion.effects.size());
+        for (int i = 0; i < effectCount; i++) {
+            // FormIDs in the form "Plugin.esp|BEEF0" or editor IDs in the form "AlchResistFrost"
+            const auto effectID = forms.FindEffect(potion.effects[i]);
+            if (!effectID) {
+                logger::error("{}: {}, skipping \"{}\"...", potion.location, effectID.error(), potion.name);
+                return false;
+            }
+            effectIDs[i] = *effectID;
+        }
+        return true;
+    }
+}
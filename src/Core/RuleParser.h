@@ -0,0 +1,41 @@
+#pragma once
+
+#include "FormSource.h"
+#include "RuleTypes.h"
+
+namespace Settings {
+    class JsonReader;
+
+    // Reads potion files into definitions, and looks up the effects they name through a form source
+    class RuleParser {
+    public:
+        RuleParser() = delete;
+
+        static void ParsePotionFile(RuleFile& ruleFile);
+
+        static void ParsePotionStream(std::istream& stream, const std::string& fileName, RuleFile& ruleFile);
+
+        static void ParseDescriptors(JsonReader& reader, DescriptorDefinitions& descriptorDefinitions);
+
+        // Queues every effect named by these files, so that each distinct identifier is looked up only once
+        static void AddIdentifiers(const std::vector<RuleFile>& ruleFiles, FormSource& forms);
+
+        // Looks up a potion's effects, or returns false after logging why one of them could not be used
+        static bool ResolveEffects(const PotionDefinition& potion, const FormSource& forms,
+                                   FormID (&effectIDs)[MAX_RULE_EFFECTS]);
+
+    private:
+        // Reads a number that must fit in an int, or returns nothing after logging why it does not
+        static std::optional<int> ReadInt(JsonReader& reader, std::string_view option);
+
+        static void ParsePotions(JsonReader& reader, std::vector<PotionDefinition>& potions, ItemKind kind);
+
+        static bool ParsePotion(JsonReader& reader, PotionDefinition& potion);
+
+        static void ParsePotencies(JsonReader& reader, PotencyMap& potencyMap);
+
+        static bool ParseCurvePoints(JsonReader& reader, std::vector<std::pair<float, float>>& points);
+
+        static void ParseGenerator(JsonReader& reader, GeneratorDefinition& generator);
+    };
+}
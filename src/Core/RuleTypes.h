@@ -0,0 +1,125 @@
+#pragma once
+
+// The rule model as read from the JSON files. Nothing here depends on the game, so that parsing, formatting and
+// matching can be built and run without it.
+namespace Settings {
+    // Same as RE::FormID
+    using FormID = std::uint32_t;
+
+    inline constexpr int MAX_EFFECTS = 4;
+
+    // "any" rules may list more effects than a potion can have
+    inline constexpr int MAX_RULE_EFFECTS = 8;
+
+    enum DescriptorFormat {
+        Before,
+        After,
+        Both
+    };
+
+    // How a rule's effects are compared with a crafted potion's
+    enum class MatchMode : std::uint8_t {
+        Exactly,  // The potion has these effects and no others
+        All,      // The potion has all of these effects, and possibly others
+        Any       // The potion has at least one of these effects
+    };
+
+    // Kinds of crafted item that are renamed. Each has its own rules, which only match items of that kind.
+    enum class ItemKind : std::uint8_t {
+        Potion,       // Potions and poisons, from "potions"
+        Enchantment,  // Player-made enchantments, from "enchantments"
+        Count
+    };
+
+    // Canonical (sorted) tuple of effect FormIDs, used to find the potion matching a set of effects
+    struct EffectSignature {
+        FormID effectIDs[MAX_EFFECTS] = {};
+        int effectCount = 0;
+        ItemKind kind = ItemKind::Potion;
+
+        constexpr EffectSignature() = default;
+
+        constexpr EffectSignature(const FormID* p_effectIDs, int p_effectCount, ItemKind p_kind = ItemKind::Potion)
+            : effectCount(p_effectCount), kind(p_kind) {
+            std::copy_n(p_effectIDs, effectCount, effectIDs);
+            std::sort(effectIDs, effectIDs + effectCount);
+        };
+
+        bool operator==(const EffectSignature& other) const = default;
+    };
+
+    struct EffectSignatureHash {
+        constexpr std::size_t operator()(const EffectSignature& signature) const noexcept {
+            // FNV-1a over the kind and the sorted formIDs
+            std::size_t hash = 14695981039346656037ull;
+            hash = (hash ^ static_cast<std::size_t>(signature.kind)) * 1099511628211ull;
+            for (int i = 0; i < signature.effectCount; i++) {
+                hash = (hash ^ signature.effectIDs[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+    };
+
+    // Shape of an effect's potency between its min and max
+    enum class PotencyCurve : std::uint8_t {
+        Linear,
+        Log,
+        Power,
+        Points  // Piecewise linear
+    };
+
+    // An effect potency as written in a JSON file
+    struct PotencyDefinition {
+        float min = 0.0f;
+        float max = 0.0f;
+        PotencyCurve curve = PotencyCurve::Linear;
+        float exponent = 1.0f;
+
+        // (fraction of the way from min to max, potency) pairs, in increasing order
+        std::vector<std::pair<float, float>> points = {};
+    };
+
+    // Potencies as read from the JSON files, keyed by effect editor ID or name
+    using PotencyMap = std::map<std::string, PotencyDefinition, std::less<>>;
+
+    // A potion as written in a JSON file, before its effects have been looked up
+    struct PotionDefinition {
+        std::string name;
+        DescriptorFormat format = Both;
+        std::vector<std::string> effects = {};
+        MatchMode match = MatchMode::Exactly;
+        int priority = 0;
+        ItemKind kind = ItemKind::Potion;
+        std::string descriptor;
+        std::string location;
+    };
+
+    // Name templates and fragments as written in a JSON file, before the effects have been looked up
+    struct GeneratorDefinition {
+        struct FragmentDefinition {
+            std::string effect;
+            std::string noun;
+            std::string adjective;
+        };
+
+        std::string descriptor;
+        std::array<std::string, MAX_EFFECTS + 1> templates = {};
+        std::vector<FragmentDefinition> fragments = {};
+        int cacheSize = 0;  // 0 if not set
+        std::string location;
+    };
+
+    // Descriptor categories in the order they were defined
+    using DescriptorDefinitions = std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+    // A potion file that has been parsed but not yet merged into a rule set
+    struct RuleFile {
+        std::filesystem::path path;
+        int priority = 0;
+        std::vector<PotionDefinition> potions = {};
+        PotencyMap potencies = {};
+        DescriptorDefinitions descriptors = {};
+        GeneratorDefinition generator = {};
+        bool parsed = false;
+    };
+}
@@ -0,0 +1,70 @@
+#include "TraceFormat.h"
+
+namespace Diagnostics {
+    namespace {
+        template <class T>
+        void WriteValue(std::ostream& output, const T& value) {
+            output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <class T>
+        bool ReadValue(std::istream& input, T& value) {
+            return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+    }
+
+    void TraceFormat::WriteHeader(std::ostream& output) {
+        WriteValue(output, MAGIC);
+        WriteValue(output, VERSION);
+    }
+
+    void TraceFormat::WritePotion(std::ostream& output, const TracedPotion& potion) {
+        WriteValue(output, static_cast<std::uint8_t>(potion.effectCount));
+        WriteValue(output, static_cast<std::uint8_t>(potion.costliestIndex));
+        WriteValue(output, static_cast<std::uint8_t>(potion.renamed));
+        for (int i = 0; i < potion.effectCount; i++) {
+            WriteValue(output, potion.effects[i]);
+        }
+
+        // The length and the bytes written must agree, or every later potion would be misread
+        const std::string_view name = std::string_view(potion.name).substr(0, MAX_NAME_LENGTH);
+        WriteValue(output, static_cast<std::uint16_t>(name.size()));
+        output.write(name.data(), name.size());
+    }
+
+    std::vector<TraceFormat::TracedPotion> TraceFormat::Read(std::istream& input, std::string_view fileName) {
+        std::uint32_t magic = 0;
+        std::uint32_t version = 0;
+        if (!ReadValue(input, magic) || !ReadValue(input, version) || magic != MAGIC || version != VERSION) {
+            throw std::runtime_error(std::format("{} is missing or was written by a different version", fileName));
+        }
+
+        std::vector<TracedPotion> potions;
+        while (true) {
+            TracedPotion potion = {};
+            std::uint8_t effectCount, costliestIndex, renamed;
+            if (!ReadValue(input, effectCount) || !ReadValue(input, costliestIndex) || !ReadValue(input, renamed)) {
+                break;
+            }
+            if (effectCount == 0 || effectCount > Settings::MAX_EFFECTS || costliestIndex >= effectCount) {
+                throw std::runtime_error(std::format("{} is corrupt", fileName));
+            }
+            potion.effectCount = effectCount;
+            potion.costliestIndex = costliestIndex;
+            potion.renamed = renamed != 0;
+
+            std::uint16_t nameLength = 0;
+            bool complete = true;
+            for (int i = 0; i < effectCount; i++) {
+                complete = complete && ReadValue(input, potion.effects[i]);
+            }
+            complete = complete && ReadValue(input, nameLength);
+            potion.name.resize(nameLength);
+            if (!complete || !input.read(potion.name.data(), nameLength)) {
+                throw std::runtime_error(std::format("{} ends part way through a potion", fileName));
+            }
+            potions.push_back(std::move(potion));
+        }
+        return potions;
+    }
+}
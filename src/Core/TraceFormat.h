@@ -0,0 +1,91 @@
+#pragma once
+
+#include "RuleTypes.h"
+
+namespace Diagnostics {
+    // The binary trace of crafted potions written while recordCrafts is enabled: a header, then the effects of each
+    // potion and the name it was given. Kept apart from the game so that traces can be replayed anywhere.
+    class TraceFormat {
+    public:
+        static constexpr std::uint32_t MAGIC = 0x54525041;  // "APRT"
+        static constexpr std::uint32_t VERSION = 1;
+
+        // Names are stored with a 16-bit length, so longer ones are cut short
+        static constexpr std::size_t MAX_NAME_LENGTH = std::numeric_limits<std::uint16_t>::max();
+
+        struct TracedEffect {
+            Settings::FormID effectID;
+            float magnitude;
+            std::uint32_t duration;
+        };
+
+        struct TracedPotion {
+            TracedEffect effects[Settings::MAX_EFFECTS];
+            int effectCount;
+            int costliestIndex;
+            bool renamed;
+            std::string name;
+        };
+
+        struct ReplayResult {
+            double totalSeconds = 0.0;
+
+            // Nanoseconds spent naming each potion, from fastest to slowest
+            std::vector<double> latencies = {};
+
+            int mismatches = 0;
+
+            // The first few potions whose name differs from the recording
+            std::vector<std::string> reportedMismatches = {};
+
+            // Latency below which a fraction of the potions were named
+            double GetPercentile(double fraction) const {
+                return latencies.empty() ? 0.0
+                                         : latencies[static_cast<std::size_t>(fraction * (latencies.size() - 1))];
+            }
+        };
+
+        TraceFormat() = delete;
+
+        static void WriteHeader(std::ostream& output);
+
+        static void WritePotion(std::ostream& output, const TracedPotion& potion);
+
+        // Reads every potion in a trace. Throws std::runtime_error if it was written by another version or is cut
+        // short.
+        static std::vector<TracedPotion> Read(std::istream& input, std::string_view fileName);
+
+        // Names every potion through getName, which takes a potion's index and returns the name it would be given,
+        // or nullopt if it would not be renamed. The names must stay valid until the replay returns. Reports up to
+        // maxReported of the names that differ from the trace.
+        template <class NameFunction>
+        static ReplayResult Replay(std::span<const TracedPotion> potions, NameFunction&& getName, int maxReported) {
+            ReplayResult result;
+            result.latencies.resize(potions.size());
+            std::vector<std::optional<std::string_view>> names(potions.size());
+
+            const auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < potions.size(); i++) {
+                const auto potionStart = std::chrono::steady_clock::now();
+                names[i] = getName(static_cast<int>(i));
+                const auto elapsed = std::chrono::steady_clock::now() - potionStart;
+                result.latencies[i] = std::chrono::duration<double, std::nano>(elapsed).count();
+            }
+            result.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            for (std::size_t i = 0; i < potions.size(); i++) {
+                const bool renamed = names[i].has_value();
+                const std::string_view name = renamed ? names[i]->substr(0, MAX_NAME_LENGTH) : std::string_view();
+                if (renamed != potions[i].renamed || name != potions[i].name) {
+                    if (result.mismatches++ < maxReported) {
+                        result.reportedMismatches.push_back(std::format(
+                            "Replayed potion {} was named \"{}\", but \"{}\" was recorded", i, name, potions[i].name));
+                    }
+                }
+            }
+
+            std::sort(result.latencies.begin(), result.latencies.end());
+            return result;
+        }
+    };
+}
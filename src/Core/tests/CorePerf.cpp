@@ -0,0 +1,224 @@
+// Times matching, potency estimation, naming and rule parsing on synthetic rules, without the game. Prints one JSON
+// object per line in the same shape as the plugin's benchmark, so results from both can be compared.
+
+#include "BenchmarkUtils.h"
+#include "NameFormat.h"
+#include "NameTemplate.h"
+#include "PotencyTable.h"
+#include "RuleMatcher.h"
+#include "RuleParser.h"
+
+namespace Tests {
+    using namespace Diagnostics;
+    using namespace Settings;
+
+    namespace {
+        constexpr int EFFECT_POOL = 512;
+        constexpr int CRAFTED_POTIONS = 4096;
+        constexpr int PASSES = 64;
+
+        // The same rule files as the plugin's benchmark
+        constexpr int FILE_COUNTS[] = {1, 10, 100};
+        constexpr int POTIONS_PER_FILE[] = {10, 100, 1000};
+
+        // Effect IDs that rules and crafted potions are drawn from
+        std::vector<FormID> MakeEffectPool() {
+            std::vector<FormID> effectPool(EFFECT_POOL);
+            std::iota(effectPool.begin(), effectPool.end(), FormID(0x1000));
+            return effectPool;
+        }
+
+        void Run(int ruleCount, int effectCount) {
+            const auto effectPool = MakeEffectPool();
+            Random random(static_cast<std::uint64_t>(ruleCount) * 31 + effectCount);
+
+            // Mostly "exactly" rules, with one in sixteen an "all" or "any" rule as in typical rule files
+            std::vector<Rule> rules(ruleCount);
+            for (int i = 0; i < ruleCount; i++) {
+                auto& rule = rules[i];
+                rule.match = i % 16 == 0 ? (i % 32 == 0 ? MatchMode::All : MatchMode::Any) : MatchMode::Exactly;
+                rule.effectCount = rule.match == MatchMode::Any ? 1 : 2 + random.Next(MAX_EFFECTS - 1);
+                rule.priority = static_cast<int>(random.Next(4));
+                PickDistinct<FormID>(random, effectPool, rule.effectCount, rule.effectIDs);
+            }
+
+            PotencyMap definitions;
+            definitions["linear"] = {.min = 5.0f, .max = 100.0f};
+            definitions["log"] = {.min = 5.0f, .max = 100.0f, .curve = PotencyCurve::Log};
+
+            RuleMatcher matcher;
+            PotencyTable potencies;
+            const double buildNanoseconds = MeasureNanosecondsPerOperation(
+                [&]() {
+                    matcher.Build(std::span<const Rule>(rules));
+                    for (FormID effectID = 0x1000; effectID < 0x1000 + EFFECT_POOL; effectID += 2) {
+                        potencies.Add(effectID, definitions[effectID % 4 == 0 ? "linear" : "log"],
+                                      PotencyDriver::Magnitude);
+                    }
+                    potencies.Sort();
+                },
+                1);
+
+            std::vector<EffectSignature> signatures(CRAFTED_POTIONS);
+            std::vector<std::array<CraftedEffect, MAX_EFFECTS>> crafted(CRAFTED_POTIONS);
+            for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                FormID effectIDs[MAX_EFFECTS];
+                PickDistinct<FormID>(random, effectPool, effectCount, effectIDs);
+                signatures[i] = EffectSignature(effectIDs, effectCount);
+                for (int j = 0; j < effectCount; j++) {
+                    const float magnitude = random.NextFloat(1.0f, 150.0f);
+                    crafted[i][j] = {effectIDs[j], magnitude, 0, PotencyTable::GetEffectCost(1.0f, magnitude, 0),
+                                     PotencyDriver::Magnitude};
+                }
+            }
+
+            const std::int64_t operations = static_cast<std::int64_t>(PASSES) * CRAFTED_POTIONS;
+            int matched = 0;
+            const double matchNanoseconds = MeasureNanosecondsPerOperation(
+                [&]() {
+                    std::int64_t total = 0;
+                    for (int pass = 0; pass < PASSES; pass++) {
+                        for (const auto& signature : signatures) {
+                            total += matcher.Find(signature);
+                        }
+                    }
+                    sink = static_cast<std::uintptr_t>(total);
+                },
+                operations);
+            for (const auto& signature : signatures) {
+                matched += matcher.Find(signature) >= 0;
+            }
+
+            const PotencyAggregation aggregations[] = {PotencyAggregation::Costliest, PotencyAggregation::Max,
+                                                       PotencyAggregation::WeightedMean};
+            for (const auto aggregation : aggregations) {
+                potencies.aggregation = aggregation;
+                const double potencyNanoseconds = MeasureNanosecondsPerOperation(
+                    [&]() {
+                        float total = 0.0f;
+                        for (int pass = 0; pass < PASSES; pass++) {
+                            for (const auto& effects : crafted) {
+                                const std::span<const CraftedEffect> used(effects.data(), effectCount);
+                                total += potencies.Estimate(used, effects[0]);
+                            }
+                        }
+                        sink = static_cast<std::uintptr_t>(total);
+                    },
+                    operations);
+                std::printf("{\"benchmark\":\"potency\",\"aggregation\":%d,\"rules\":%d,\"effects\":%d,"
+                            "\"nsPerOp\":%.2f}\n",
+                            static_cast<int>(aggregation), ruleCount, effectCount, potencyNanoseconds);
+            }
+
+            std::printf("{\"benchmark\":\"build\",\"rules\":%d,\"effects\":%d,\"nsPerOp\":%.2f}\n", ruleCount,
+                        effectCount, buildNanoseconds);
+            std::printf("{\"benchmark\":\"match\",\"rules\":%d,\"effects\":%d,\"matched\":%d,\"nsPerOp\":%.2f}\n",
+                        ruleCount, effectCount, matched, matchNanoseconds);
+        }
+
+        // Filling in descriptors, which the plugin does for every rule when it loads them, and expanding name
+        // templates, which it does for every crafted potion that no rule matches
+        void RunNaming(int effectCount) {
+            const auto effectPool = MakeEffectPool();
+            Random random(static_cast<std::uint64_t>(effectCount) * 7);
+
+            constexpr std::string_view DESCRIPTORS[] = {"Weak", "Lesser", "", "Strong", "Potent", "Supreme"};
+            std::vector<std::string> names(CRAFTED_POTIONS);
+            std::vector<DescriptorFormat> formats(CRAFTED_POTIONS);
+            for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                // The descriptor at the start, the end or in between
+                names[i] = i % 3 == 0   ? std::format("{{}}Potion {}", i)
+                           : i % 3 == 1 ? std::format("Draught {} {{}}", i)
+                                        : std::format("Elixir {{}} {}", i);
+                formats[i] = NameFormat::GetDescriptorFormat(names[i]);
+            }
+
+            NameTemplate::FragmentMap fragments;
+            for (const auto effectID : effectPool) {
+                fragments[effectID] = {std::format("Noun{:X}", effectID), std::format("Adjective{:X}", effectID)};
+            }
+            const std::string_view nameTemplate =
+                effectCount == 2 ? "{}{noun1} of {adjective2}" : "{}{adjective3} {noun1} of {adjective2}";
+            std::vector<std::array<FormID, MAX_EFFECTS>> orderedIDs(CRAFTED_POTIONS);
+            for (auto& effectIDs : orderedIDs) {
+                PickDistinct<FormID>(random, effectPool, effectCount, effectIDs.data());
+            }
+
+            const std::int64_t operations = static_cast<std::int64_t>(PASSES) * CRAFTED_POTIONS;
+            const double formatNanoseconds = MeasureNanosecondsPerOperation(
+                [&]() {
+                    std::size_t total = 0;
+                    for (int pass = 0; pass < PASSES; pass++) {
+                        for (int i = 0; i < CRAFTED_POTIONS; i++) {
+                            const auto descriptor = DESCRIPTORS[(pass + i) % std::size(DESCRIPTORS)];
+                            total += NameFormat::FormatName(names[i], formats[i], descriptor).size();
+                        }
+                    }
+                    sink = total;
+                },
+                operations);
+
+            const double templateNanoseconds = MeasureNanosecondsPerOperation(
+                [&]() {
+                    std::size_t total = 0;
+                    for (int pass = 0; pass < PASSES; pass++) {
+                        for (const auto& effectIDs : orderedIDs) {
+                            const std::span<const FormID> used(effectIDs.data(), effectCount);
+                            total += NameTemplate::Expand(nameTemplate, used, fragments).size();
+                        }
+                    }
+                    sink = total;
+                },
+                operations);
+
+            std::printf("{\"benchmark\":\"format\",\"effects\":%d,\"nsPerOp\":%.2f}\n", effectCount,
+                        formatNanoseconds);
+            std::printf("{\"benchmark\":\"template\",\"effects\":%d,\"nsPerOp\":%.2f}\n", effectCount,
+                        templateNanoseconds);
+        }
+
+        // Parsing only, one file after another. The plugin also parses files in parallel, which needs the parallel
+        // algorithms of its toolchain.
+        void RunParsing(int fileCount, int potionsPerFile) {
+            const auto effectPool = MakeEffectPool();
+            Random random(static_cast<std::uint64_t>(fileCount) * 13 + potionsPerFile);
+            const std::string json = MakeRuleFileJson(random, effectPool, potionsPerFile);
+
+            std::vector<RuleFile> ruleFiles(fileCount);
+            const double nanoseconds = MeasureNanosecondsPerOperation(
+                [&]() {
+                    for (auto& ruleFile : ruleFiles) {
+                        std::istringstream stream(json);
+                        RuleParser::ParsePotionStream(stream, "Benchmark.json", ruleFile);
+                    }
+                },
+                1);
+            const auto parsed = std::ranges::count_if(ruleFiles, [&](const RuleFile& ruleFile) {
+                return ruleFile.parsed && (int)ruleFile.potions.size() == potionsPerFile;
+            });
+
+            std::printf("{\"benchmark\":\"parse\",\"mode\":\"serial\",\"files\":%d,\"potionsPerFile\":%d,"
+                        "\"bytesPerFile\":%zu,\"parsed\":%d,\"msTotal\":%.3f}\n",
+                        fileCount, potionsPerFile, json.size(), static_cast<int>(parsed), nanoseconds / 1e6);
+        }
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    for (const int ruleCount : {10, 1000, 100000}) {
+        for (int effectCount = 2; effectCount <= Settings::MAX_EFFECTS; effectCount++) {
+            Tests::Run(ruleCount, effectCount);
+        }
+    }
+    for (int effectCount = 2; effectCount <= Settings::MAX_EFFECTS; effectCount++) {
+        Tests::RunNaming(effectCount);
+    }
+    for (const int fileCount : Tests::FILE_COUNTS) {
+        for (const int potionsPerFile : Tests::POTIONS_PER_FILE) {
+            Tests::RunParsing(fileCount, potionsPerFile);
+        }
+    }
+    return 0;
+}
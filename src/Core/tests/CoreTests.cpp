@@ -0,0 +1,348 @@
+// Unit tests for the core library, run by ctest. Forms come from MockFormSource, so no game is needed.
+
+#include "JsonReader.h"
+#include "MockFormSource.h"
+#include "NameFormat.h"
+#include "NameTemplate.h"
+#include "PotencyTable.h"
+#include "RuleMatcher.h"
+#include "RuleParser.h"
+#include "TraceFormat.h"
+
+namespace Tests {
+    using namespace Settings;
+
+    namespace {
+        int failures = 0;
+
+#define CHECK(condition)                                                                            \
+    do {                                                                                            \
+        if (!(condition)) {                                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);      \
+            failures++;                                                                             \
+        }                                                                                           \
+    } while (false)
+
+        constexpr FormID RESTORE_HEALTH = 0x3EB15;
+        constexpr FormID RESTORE_MAGICKA = 0x3EB17;
+        constexpr FormID RESTORE_STAMINA = 0x3EB16;
+        constexpr FormID PARALYSIS = 0x73F30;
+
+        MockFormSource MakeForms() {
+            MockFormSource forms;
+            forms.effects = {{"AlchRestoreHealth", RESTORE_HEALTH},
+                             {"AlchRestoreMagicka", RESTORE_MAGICKA},
+                             {"AlchRestoreStamina", RESTORE_STAMINA},
+                             {"Skyrim.esm|73F30", PARALYSIS}};
+            forms.otherForms = {{"Skyrim.esm|F", 0xF}};
+            return forms;
+        }
+
+        RuleFile Parse(std::string_view json) {
+            std::istringstream stream{std::string(json)};
+            RuleFile ruleFile;
+            RuleParser::ParsePotionStream(stream, "Test.json", ruleFile);
+            return ruleFile;
+        }
+
+        // Turns parsed potions into rules the way the plugin does, dropping any whose effects cannot be found
+        std::vector<Rule> Resolve(const RuleFile& ruleFile, MockFormSource& forms) {
+            RuleParser::AddIdentifiers({ruleFile}, forms);
+            forms.Resolve();
+
+            std::vector<Rule> rules;
+            for (const auto& potion : ruleFile.potions) {
+                Rule rule{.name = potion.name,
+                          .effectCount = static_cast<int>(potion.effects.size()),
+                          .match = potion.match,
+                          .priority = potion.priority,
+                          .kind = potion.kind};
+                if (RuleParser::ResolveEffects(potion, forms, rule.effectIDs)) {
+                    rules.push_back(rule);
+                }
+            }
+            return rules;
+        }
+
+        int Find(const RuleMatcher& matcher, std::initializer_list<FormID> effectIDs,
+                 ItemKind kind = ItemKind::Potion) {
+            return matcher.Find({std::data(effectIDs), static_cast<int>(effectIDs.size()), kind});
+        }
+
+        void TestParsing() {
+            const auto ruleFile = Parse(R"({
+                "priority": 3,
+                "potions": [
+                    {"name": "{} Vigor", "descriptor": "potion",
+                     "effects": ["AlchRestoreHealth", "AlchRestoreStamina"]},
+                    {"name": "Bad", "effects": ["AlchRestoreHealth"]}
+                ],
+                "effectPotencies": {"AlchRestoreHealth": {"min": 10, "max": 60, "curve": "log"}}
+            })");
+            CHECK(ruleFile.parsed);
+            CHECK(ruleFile.priority == 3);
+            CHECK(ruleFile.potions.size() == 1);
+            CHECK(ruleFile.potions[0].name == "{} Vigor");
+            CHECK(ruleFile.potions[0].format == After);
+            CHECK(ruleFile.potencies.at("AlchRestoreHealth").curve == PotencyCurve::Log);
+        }
+
+        // Whether a whole document can be skipped over without a parse error
+        bool IsValidJson(std::string_view json) {
+            std::istringstream stream{std::string(json)};
+            try {
+                JsonReader reader(stream, "Test.json");
+                reader.Skip();
+                reader.ExpectEnd();
+                return true;
+            } catch (JsonReader::ParseError&) {
+                return false;
+            }
+        }
+
+        void TestByteOrderMark() {
+            const auto ruleFile =
+                Parse("\xEF\xBB\xBF{\"potions\": [{\"name\": \"A\", \"effects\": [\"B\", \"C\"]}]}");
+            CHECK(ruleFile.parsed);
+            CHECK(ruleFile.potions.size() == 1);
+
+            // Columns are counted from after the mark, as editors show them
+            std::istringstream stream{"\xEF\xBB\xBF  1"};
+            JsonReader reader(stream, "Test.json");
+            CHECK(reader.PeekType() == JsonReader::Type::Number);
+            CHECK(reader.GetLocation() == "Test.json:1:3");
+
+            CHECK(!IsValidJson("\xEF\xBB{}"));
+            CHECK(!IsValidJson("{}\xEF\xBB\xBF"));
+        }
+
+        void TestTrailingCommas() {
+            const auto ruleFile = Parse(R"({
+                "potions": [
+                    {"name": "A", "effects": ["B", "C",], "priority": 2,},
+                ],
+                "effectPotencies": {"B": {"min": 1, "max": 2, "curve": "points", "points": [[0, 0], [1, 1],],},},
+            })");
+            CHECK(ruleFile.parsed);
+            CHECK(ruleFile.potions.size() == 1);
+            CHECK(ruleFile.potions[0].effects.size() == 2 && ruleFile.potions[0].priority == 2);
+            CHECK(ruleFile.potencies.at("B").points.size() == 2);
+
+            CHECK(IsValidJson("[1, 2 /* last */ , ]"));
+            CHECK(IsValidJson("{\"a\": [], }"));
+            CHECK(!IsValidJson("[,]"));
+            CHECK(!IsValidJson("{,}"));
+            CHECK(!IsValidJson("[1,,]"));
+            CHECK(!IsValidJson("{\"a\": 1,,}"));
+        }
+
+        void TestOutOfRangeIntegers() {
+            // Out of range for an int, so rejected rather than converted, and the file still loads
+            const auto ruleFile = Parse(R"({
+                "priority": 1e12,
+                "potions": [{"name": "A", "effects": ["AlchRestoreHealth", "AlchRestoreMagicka"], "priority": -1e300}]
+            })");
+            CHECK(ruleFile.parsed);
+            CHECK(ruleFile.priority == 0);
+            CHECK(ruleFile.potions.size() == 1 && ruleFile.potions[0].priority == 0);
+        }
+
+        void TestResolveEffects() {
+            auto forms = MakeForms();
+            const auto ruleFile = Parse(R"({"potions": [
+                {"name": "Found", "effects": ["AlchRestoreHealth", "Skyrim.esm|73F30"]},
+                {"name": "Missing", "effects": ["AlchRestoreHealth", "AlchNothing"]},
+                {"name": "Not an effect", "effects": ["AlchRestoreHealth", "Skyrim.esm|F"]}
+            ]})");
+            const auto rules = Resolve(ruleFile, forms);
+            CHECK(rules.size() == 1);
+            CHECK(rules[0].effectIDs[0] == RESTORE_HEALTH && rules[0].effectIDs[1] == PARALYSIS);
+        }
+
+        void TestMatching() {
+            auto forms = MakeForms();
+            const auto ruleFile = Parse(R"({"potions": [
+                {"name": "Health Magicka", "effects": ["AlchRestoreHealth", "AlchRestoreMagicka"]},
+                {"name": "Magicka Health", "effects": ["AlchRestoreMagicka", "AlchRestoreHealth"], "priority": 1},
+                {"name": "Health Stamina", "effects": ["AlchRestoreHealth", "AlchRestoreStamina"]},
+                {"name": "Any Paralysis", "effects": ["Skyrim.esm|73F30"], "match": "any", "priority": 5},
+                {"name": "All Restores", "effects": ["AlchRestoreHealth", "AlchRestoreMagicka", "AlchRestoreStamina"],
+                 "match": "all", "priority": 1}
+            ], "enchantments": [
+                {"name": "Enchantment", "effects": ["AlchRestoreHealth", "AlchRestoreStamina"], "priority": -1}
+            ]})");
+            const auto rules = Resolve(ruleFile, forms);
+            CHECK(rules.size() == 6);
+
+            RuleMatcher matcher;
+            matcher.Build(std::span<const Rule>(rules));
+            CHECK(matcher.GetExactCount() == 3);
+            CHECK(matcher.GetPatternCount() == 2);
+
+            // The same effects in any order, with the higher priority duplicate chosen
+            CHECK(Find(matcher, {RESTORE_HEALTH, RESTORE_MAGICKA}) == 1);
+            CHECK(Find(matcher, {RESTORE_MAGICKA, RESTORE_HEALTH}) == 1);
+            CHECK(Find(matcher, {RESTORE_STAMINA, RESTORE_HEALTH}) == 2);
+
+            // Pattern rules win over exact ones only with a higher priority
+            CHECK(Find(matcher, {RESTORE_HEALTH, RESTORE_STAMINA, PARALYSIS}) == 3);
+            CHECK(Find(matcher, {RESTORE_STAMINA, RESTORE_MAGICKA, RESTORE_HEALTH}) == 4);
+            CHECK(Find(matcher, {RESTORE_STAMINA, RESTORE_MAGICKA}) == -1);
+
+            // Rules only match items of their own kind
+            CHECK(Find(matcher, {RESTORE_HEALTH, RESTORE_STAMINA}, ItemKind::Enchantment) == 5);
+            CHECK(Find(matcher, {RESTORE_HEALTH, RESTORE_MAGICKA}, ItemKind::Enchantment) == -1);
+        }
+
+        void TestPotency() {
+            PotencyMap definitions;
+            definitions["linear"] = {.min = 10.0f, .max = 60.0f};
+            definitions["power"] = {.min = 0.0f, .max = 100.0f, .curve = PotencyCurve::Power, .exponent = 2.0f};
+
+            PotencyTable table;
+            table.Add(RESTORE_MAGICKA, definitions["linear"], PotencyDriver::Magnitude);
+            table.Add(RESTORE_HEALTH, definitions["power"], PotencyDriver::Magnitude);
+            table.Add(PARALYSIS, definitions["linear"], PotencyDriver::Duration);
+            table.Sort();
+            CHECK(table.curveTables.size() == PotencyTable::CURVE_RESOLUTION);
+            CHECK(table.Find(RESTORE_HEALTH) && table.Find(RESTORE_HEALTH)->curveOffset == 0);
+
+            const CraftedEffect magicka{RESTORE_MAGICKA, 35.0f, 0, 10.0f, PotencyDriver::Magnitude};
+            const CraftedEffect health{RESTORE_HEALTH, 100.0f, 0, 30.0f, PotencyDriver::Magnitude};
+            const CraftedEffect paralysis{PARALYSIS, 1.0f, 60, 20.0f, PotencyDriver::Duration};
+            CHECK(std::abs(table.EstimateEffect(magicka) - 0.5f) < 1e-6f);
+            CHECK(std::abs(table.EstimateEffect(health) - 1.0f) < 1e-6f);
+            CHECK(table.EstimateEffect(paralysis) == 1.0f);
+
+            // Effects without an entry use the default range, driven by the flags copied from the game
+            const CraftedEffect stamina{RESTORE_STAMINA, 52.5f, 0, 5.0f, PotencyDriver::Magnitude};
+            CHECK(std::abs(table.EstimateEffect(stamina) - 0.5f) < 1e-6f);
+
+            const CraftedEffect effects[] = {magicka, health};
+            CHECK(table.Estimate(effects, health) == table.EstimateEffect(health));
+            table.aggregation = PotencyAggregation::Max;
+            CHECK(table.Estimate(effects, magicka) == 1.0f);
+            table.aggregation = PotencyAggregation::WeightedMean;
+            CHECK(std::abs(table.Estimate(effects, magicka) - (0.5f * 10.0f + 1.0f * 30.0f) / 40.0f) < 1e-6f);
+
+            CHECK(PotencyTable::GetEffectCost(1.0f, 10.0f, 0) == std::pow(10.0f, 1.1f));
+        }
+
+        void TestNameTemplate() {
+            NameTemplate::FragmentMap fragments;
+            fragments[RESTORE_HEALTH] = {"Vigor", "Healing"};
+            fragments[RESTORE_MAGICKA] = {"Focus", ""};
+            fragments[RESTORE_STAMINA] = {"", "Tireless"};
+
+            const auto expand = [&fragments](std::string_view nameTemplate, std::initializer_list<FormID> effectIDs) {
+                CHECK(!NameTemplate::Validate(nameTemplate, static_cast<int>(effectIDs.size())));
+                return NameTemplate::Expand(nameTemplate, {std::data(effectIDs), effectIDs.size()}, fragments);
+            };
+            CHECK(expand("{}{noun1} of {adjective2}", {RESTORE_HEALTH, RESTORE_STAMINA}) == "{}Vigor of Tireless");
+            CHECK(expand("{adjective2} {noun1}", {RESTORE_MAGICKA, RESTORE_HEALTH}) == "Healing Focus");
+
+            // Fragments without the part a placeholder needs, or without any, leave the template unused
+            CHECK(expand("{noun1} of {adjective2}", {RESTORE_STAMINA, RESTORE_HEALTH}).empty());
+            CHECK(expand("{noun1} of {adjective2}", {RESTORE_HEALTH, RESTORE_MAGICKA}).empty());
+            CHECK(expand("{noun1} of {adjective2}", {RESTORE_HEALTH, PARALYSIS}).empty());
+        }
+
+        // Whether reading a trace fails, as it must for one that is cut short or from another version
+        bool IsCorruptTrace(const std::string& trace) {
+            std::istringstream stream(trace);
+            try {
+                Diagnostics::TraceFormat::Read(stream, "Test.trace");
+                return false;
+            } catch (std::runtime_error&) {
+                return true;
+            }
+        }
+
+        void TestTrace() {
+            using Diagnostics::TraceFormat;
+
+            const std::string longName(TraceFormat::MAX_NAME_LENGTH + 10, 'x');
+            auto forms = MakeForms();
+            const auto ruleFile = Parse(std::format(R"({{"potions": [
+                {{"name": "Vigor", "effects": ["AlchRestoreHealth", "AlchRestoreStamina"]}},
+                {{"name": "{}", "effects": ["AlchRestoreMagicka", "AlchRestoreStamina"]}}
+            ]}})", longName));
+            const auto rules = Resolve(ruleFile, forms);
+            RuleMatcher matcher;
+            matcher.Build(std::span<const Rule>(rules));
+            CHECK(rules.size() == 2);
+
+            // Named as recorded, not renamed, named too long to store whole, and named under older rules
+            const TraceFormat::TracedPotion recorded[] = {
+                {{{RESTORE_STAMINA, 10.0f, 0}, {RESTORE_HEALTH, 25.0f, 0}}, 2, 1, true, "Vigor"},
+                {{{RESTORE_MAGICKA, 10.0f, 0}, {PARALYSIS, 1.0f, 5}}, 2, 0, false, ""},
+                {{{RESTORE_MAGICKA, 10.0f, 0}, {RESTORE_STAMINA, 5.0f, 0}}, 2, 0, true, longName},
+                {{{RESTORE_HEALTH, 10.0f, 0}, {RESTORE_STAMINA, 5.0f, 0}}, 2, 0, true, "Old Vigor"}};
+            std::stringstream stream;
+            TraceFormat::WriteHeader(stream);
+            for (const auto& potion : recorded) {
+                TraceFormat::WritePotion(stream, potion);
+            }
+            const std::string trace = stream.str();
+
+            const auto potions = TraceFormat::Read(stream, "Test.trace");
+            CHECK(potions.size() == std::size(recorded));
+            CHECK(potions[0].costliestIndex == 1 && potions[0].effects[1].effectID == RESTORE_HEALTH);
+            CHECK(potions[0].effects[1].magnitude == 25.0f && potions[1].effects[1].duration == 5);
+            CHECK(!potions[1].renamed && potions[1].name.empty());
+            CHECK(potions[2].name == std::string_view(longName).substr(0, TraceFormat::MAX_NAME_LENGTH));
+            CHECK(potions[3].name == "Old Vigor");
+
+            // Replayed offline, naming through the matcher in place of the game
+            std::vector<std::string> names(potions.size());
+            const auto result = TraceFormat::Replay(
+                potions,
+                [&](int i) -> std::optional<std::string_view> {
+                    FormID effectIDs[MAX_EFFECTS] = {};
+                    for (int j = 0; j < potions[i].effectCount; j++) {
+                        effectIDs[j] = potions[i].effects[j].effectID;
+                    }
+                    const int index = matcher.Find({effectIDs, potions[i].effectCount, ItemKind::Potion});
+                    if (index < 0) {
+                        return std::nullopt;
+                    }
+                    const auto name = rules[index].name;
+                    names[i] = NameFormat::FormatName(name, NameFormat::GetDescriptorFormat(name), "");
+                    return names[i];
+                },
+                1);
+            CHECK(result.latencies.size() == potions.size());
+            CHECK(result.GetPercentile(0.0) <= result.GetPercentile(1.0));
+            CHECK(result.mismatches == 1);
+            CHECK(result.reportedMismatches.size() == 1 &&
+                  result.reportedMismatches[0].starts_with("Replayed potion 3 was named \"Vigor\""));
+
+            CHECK(IsCorruptTrace(""));
+            CHECK(IsCorruptTrace(trace.substr(0, 4) + std::string(4, '\0')));
+            CHECK(!IsCorruptTrace(trace.substr(0, 8)));
+            CHECK(IsCorruptTrace(trace.substr(0, 20)));
+            CHECK(IsCorruptTrace(trace.substr(0, trace.size() - 1)));
+        }
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::off);
+
+    Tests::TestParsing();
+    Tests::TestByteOrderMark();
+    Tests::TestTrailingCommas();
+    Tests::TestOutOfRangeIntegers();
+    Tests::TestResolveEffects();
+    Tests::TestMatching();
+    Tests::TestPotency();
+    Tests::TestNameTemplate();
+    Tests::TestTrace();
+
+    if (Tests::failures > 0) {
+        std::fprintf(stderr, "%d checks failed\n", Tests::failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "FormSource.h"
+
+namespace Tests {
+    // Stands in for the game's forms: identifiers are resolved from a fixed table instead of the data handler
+    class MockFormSource : public Settings::FormSource {
+    public:
+        // Identifiers naming magic effects, and ones naming forms of some other type
+        std::unordered_map<std::string, Settings::FormID> effects = {};
+        std::unordered_map<std::string, Settings::FormID> otherForms = {};
+
+        void Add(std::string_view identifier) override { queued.insert(std::string(identifier)); }
+
+        void Resolve() override { resolved = queued; }
+
+        std::expected<Settings::FormID, std::string> FindEffect(std::string_view identifier) const override {
+            const std::string key(identifier);
+            if (!resolved.contains(key)) {
+                return std::unexpected(std::format("\"{}\" was never queued", identifier));
+            }
+            if (const auto it = effects.find(key); it != effects.end()) {
+                return it->second;
+            }
+            if (otherForms.contains(key)) {
+                return std::unexpected(std::format("\"{}\" is not an alchemy effect", identifier));
+            }
+            return std::unexpected(std::format("Failed to load ID \"{}\"", identifier));
+        }
+
+    private:
+        std::unordered_set<std::string> queued = {};
+        std::unordered_set<std::string> resolved = {};
+    };
+}
@@ -0,0 +1,282 @@
+#include "Coverage.h"
+
+#include "logger.h"
+#include "RenameEngine.h"
+#include "Utils.h"
+
+namespace Diagnostics {
+    using Settings::SettingsLoader;
+
+    namespace {
+        constexpr int MAX_EFFECTS = SettingsLoader::MAX_EFFECTS;
+
+        // Effects found in both of two sorted effect lists, in order
+        int Intersect(const std::uint16_t* a, int aCount, const std::uint16_t* b, int bCount, std::uint16_t* shared) {
+            int count = 0;
+            for (int i = 0, j = 0; i < aCount && j < bCount;) {
+                if (a[i] < b[j]) {
+                    i++;
+                } else if (b[j] < a[i]) {
+                    j++;
+                } else {
+                    shared[count++] = a[i];
+                    i++;
+                    j++;
+                }
+            }
+            return count;
+        }
+
+        std::uint64_t Pack(const std::uint16_t* effects, int count) {
+            std::uint64_t packed = 0;
+            for (int i = 0; i < count; i++) {
+                packed = packed << 16 | static_cast<std::uint64_t>(effects[i] + 1);
+            }
+            return packed;
+        }
+    }
+
+    bool Coverage::Start() {
+        if (running.exchange(true)) {
+            return false;
+        }
+
+        std::shared_ptr<const Table> existing;
+        {
+            std::lock_guard lock(tableLock);
+            existing = table;
+        }
+
+        // Forms are read here on the main thread; the enumeration only needs their effect indices
+        std::vector<Ingredient> ingredients;
+        auto collected = existing ? nullptr : CollectIngredients(ingredients);
+
+        std::thread([existing, collected, ingredients = std::move(ingredients)]() {
+            try {
+                std::shared_ptr<const Table> result = existing;
+                if (!result) {
+                    const auto start = std::chrono::steady_clock::now();
+                    Enumerate(*collected, ingredients);
+                    logger::info(
+                        "Enumerated {} combinations of {} ingredients into {} effect combinations in {:.2f} ms",
+                        collected->ingredientCombinations, collected->ingredientCount,
+                        collected->combinations.size(),
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                    result = collected;
+                    std::lock_guard lock(tableLock);
+                    table = result;
+                }
+
+                const auto rules = SettingsLoader::GetSingleton()->AcquireRules();
+                if (!rules) {
+                    throw std::runtime_error("Rules have not been loaded");
+                }
+                Report(*result, *rules);
+            } catch (std::exception& e) {
+                logger::error("Failed to check rule coverage: {}", e.what());
+            }
+            running.store(false);
+        }).detach();
+        return true;
+    }
+
+    std::shared_ptr<Coverage::Table> Coverage::CollectIngredients(std::vector<Ingredient>& ingredients) {
+        auto result = std::make_shared<Table>();
+        const auto dataHandler = RE::TESDataHandler::GetSingleton();
+        if (!dataHandler) {
+            return result;
+        }
+
+        std::unordered_map<RE::FormID, std::uint16_t> effectIndices;
+        for (const auto ingredientItem : dataHandler->GetFormArray<RE::IngredientItem>()) {
+            if (!ingredientItem) {
+                continue;
+            }
+            Ingredient ingredient;
+            for (const auto effect : ingredientItem->effects) {
+                if (!effect || !effect->baseEffect || ingredient.effectCount == MAX_EFFECTS) {
+                    continue;
+                }
+                const auto [entry, inserted] = effectIndices.try_emplace(
+                    effect->baseEffect->GetFormID(), static_cast<std::uint16_t>(result->effectIDs.size()));
+                if (inserted) {
+                    if (result->effectIDs.size() == std::numeric_limits<std::uint16_t>::max() - 1) {
+                        throw std::runtime_error("Too many distinct ingredient effects to enumerate");
+                    }
+                    result->effectIDs.push_back(entry->first);
+                }
+                const auto end = ingredient.effects.begin() + ingredient.effectCount;
+                if (std::find(ingredient.effects.begin(), end, entry->second) == end) {
+                    ingredient.effects[ingredient.effectCount++] = entry->second;
+                }
+            }
+            if (ingredient.effectCount > 0) {
+                std::sort(ingredient.effects.begin(), ingredient.effects.begin() + ingredient.effectCount);
+                ingredients.push_back(ingredient);
+            }
+        }
+        result->ingredientCount = ingredients.size();
+        return result;
+    }
+
+    void Coverage::Enumerate(Table& result, const std::vector<Ingredient>& ingredients) {
+        const auto count = static_cast<std::uint32_t>(ingredients.size());
+
+        // Each first ingredient gets its own run of distinct combinations, so workers never share a container.
+        // Runs are only as large as the combinations they find, which repeat far more often than not.
+        std::vector<std::vector<Combination>> runs(count);
+        std::atomic_uint64_t ingredientCombinations = 0;
+        std::atomic_uint64_t overfull = 0;
+
+        std::vector<std::uint32_t> firsts(count);
+        std::iota(firsts.begin(), firsts.end(), 0);
+        std::for_each(std::execution::par, firsts.begin(), firsts.end(), [&](std::uint32_t i) {
+            std::unordered_map<PackedSignature, std::uint32_t> found;
+            std::uint64_t localCombinations = 0;
+            std::uint64_t localOverfull = 0;
+            const auto add = [&](std::uint16_t* effects, int effectCount) {
+                localCombinations++;
+                if (effectCount > MAX_EFFECTS) {
+                    localOverfull++;
+                    return;
+                }
+                found[Pack(effects, effectCount)]++;
+            };
+
+            const auto& a = ingredients[i];
+            for (std::uint32_t j = i + 1; j < count; j++) {
+                const auto& b = ingredients[j];
+                std::uint16_t ab[MAX_EFFECTS];
+                const int abCount = Intersect(a.effects.data(), a.effectCount, b.effects.data(), b.effectCount, ab);
+                if (abCount > 0) {
+                    add(ab, abCount);
+                }
+
+                for (std::uint32_t k = j + 1; k < count; k++) {
+                    const auto& c = ingredients[k];
+                    std::uint16_t ac[MAX_EFFECTS], bc[MAX_EFFECTS];
+                    const int acCount =
+                        Intersect(a.effects.data(), a.effectCount, c.effects.data(), c.effectCount, ac);
+                    const int bcCount =
+                        Intersect(b.effects.data(), b.effectCount, c.effects.data(), c.effectCount, bc);
+
+                    // A triple where an ingredient shares nothing crafts the same potion as the pair without it
+                    if (acCount + bcCount == 0 || abCount + acCount == 0 || abCount + bcCount == 0) {
+                        continue;
+                    }
+
+                    std::uint16_t effects[MAX_EFFECTS * 3];
+                    std::copy_n(ab, abCount, effects);
+                    std::copy_n(ac, acCount, effects + abCount);
+                    std::copy_n(bc, bcCount, effects + abCount + acCount);
+                    int effectCount = abCount + acCount + bcCount;
+                    std::sort(effects, effects + effectCount);
+                    effectCount = static_cast<int>(std::unique(effects, effects + effectCount) - effects);
+                    add(effects, effectCount);
+                }
+            }
+
+            auto& run = runs[i];
+            run.reserve(found.size());
+            for (const auto& [signature, combinations] : found) {
+                run.push_back({signature, combinations});
+            }
+            ingredientCombinations += localCombinations;
+            overfull += localOverfull;
+        });
+
+        std::size_t total = 0;
+        for (const auto& run : runs) {
+            total += run.size();
+        }
+        auto& combinations = result.combinations;
+        combinations.reserve(total);
+        for (auto& run : runs) {
+            combinations.insert(combinations.end(), run.begin(), run.end());
+            std::vector<Combination>().swap(run);
+        }
+        std::sort(std::execution::par, combinations.begin(), combinations.end(),
+                  [](const Combination& x, const Combination& y) { return x.signature < y.signature; });
+
+        // Merge the same combination found from different first ingredients
+        std::size_t merged = 0;
+        for (std::size_t i = 0; i < combinations.size(); i++) {
+            if (merged > 0 && combinations[merged - 1].signature == combinations[i].signature) {
+                combinations[merged - 1].ingredientCombinations += combinations[i].ingredientCombinations;
+            } else {
+                combinations[merged++] = combinations[i];
+            }
+        }
+        combinations.resize(merged);
+        combinations.shrink_to_fit();
+
+        result.ingredientCombinations = ingredientCombinations.load();
+        result.overfull = overfull.load();
+    }
+
+    void Coverage::Report(const Table& result, const SettingsLoader::RuleSet& rules) {
+        std::size_t covered = 0;
+        std::uint64_t coveredCombinations = 0;
+        std::uint64_t renameableCombinations = 0;
+        std::vector<const Combination*> uncovered;
+        for (const auto& combination : result.combinations) {
+            const auto signature = Unpack(result, combination.signature);
+
+            // Potions with fewer effects keep their names whatever the rules say
+            if (signature.effectCount < Hooks::ItemTraits<RE::AlchemyItem>::MIN_EFFECTS) {
+                continue;
+            }
+            renameableCombinations += combination.ingredientCombinations;
+            if (rules.FindPotion(signature)) {
+                covered++;
+                coveredCombinations += combination.ingredientCombinations;
+            } else {
+                uncovered.push_back(&combination);
+            }
+        }
+
+        const auto renameable = covered + uncovered.size();
+        logger::info("Rules cover {} of {} craftable effect combinations ({:.1f}%), made by {} of {} ingredient "
+                     "combinations ({:.1f}%)",
+                     covered, renameable, renameable ? 100.0 * covered / renameable : 100.0, coveredCombinations,
+                     renameableCombinations,
+                     renameableCombinations ? 100.0 * coveredCombinations / renameableCombinations : 100.0);
+        if (result.overfull > 0) {
+            logger::info("{} ingredient combinations share more than {} effects and are never renamed",
+                         result.overfull, MAX_EFFECTS);
+        }
+        if (uncovered.empty()) {
+            return;
+        }
+        if (rules.generator) {
+            logger::info("Uncovered combinations are named from the name templates where they have fragments");
+        }
+
+        const auto reported = std::min<std::size_t>(uncovered.size(), MAX_REPORTED_UNCOVERED);
+        std::partial_sort(uncovered.begin(), uncovered.begin() + reported, uncovered.end(),
+                          [](const Combination* x, const Combination* y) {
+                              return x->ingredientCombinations > y->ingredientCombinations;
+                          });
+        logger::info("Most common effect combinations without a rule:");
+        for (std::size_t i = 0; i < reported; i++) {
+            const auto signature = Unpack(result, uncovered[i]->signature);
+            std::string effectNames;
+            for (int j = 0; j < signature.effectCount; j++) {
+                const auto effect = RE::TESForm::LookupByID<RE::EffectSetting>(signature.effectIDs[j]);
+                const auto effectName =
+                    effect ? std::string(effect->GetName()) : Utils::GetHexString(signature.effectIDs[j]);
+                effectNames += std::format("{}{}", j > 0 ? ", " : "", effectName);
+            }
+            logger::info("    {} ({} ingredient combinations)", effectNames, uncovered[i]->ingredientCombinations);
+        }
+    }
+
+    SettingsLoader::EffectSignature Coverage::Unpack(const Table& result, PackedSignature signature) {
+        RE::FormID effectIDs[MAX_EFFECTS] = {};
+        int effectCount = 0;
+        for (; signature != 0; signature >>= 16) {
+            effectIDs[effectCount++] = result.effectIDs[(signature & 0xFFFF) - 1];
+        }
+        return {effectIDs, effectCount, SettingsLoader::ItemKind::Potion};
+    }
+}
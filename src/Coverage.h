@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+namespace Diagnostics {
+    // Every effect combination that can be crafted from two or three of the loaded ingredients, and how the rules
+    // cover them. Ingredients do not change once the game data has loaded, so they are only enumerated once.
+    class Coverage {
+    private:
+        // Uncovered combinations logged per report, the most common first
+        static constexpr int MAX_REPORTED_UNCOVERED = 20;
+
+        // Sorted effect indices, each plus one in 16 bits, so that a combination fits in one integer
+        using PackedSignature = std::uint64_t;
+
+        static_assert(Settings::SettingsLoader::MAX_EFFECTS * 16 <= 64);
+
+        // An ingredient's distinct effects, as indices into Table::effectIDs
+        struct Ingredient {
+            std::array<std::uint16_t, Settings::SettingsLoader::MAX_EFFECTS> effects = {};
+            int effectCount = 0;
+        };
+
+        struct Combination {
+            PackedSignature signature;
+            std::uint32_t ingredientCombinations;  // Pairs and triples of ingredients that craft it
+        };
+
+        struct Table {
+            std::vector<RE::FormID> effectIDs;
+
+            // Sorted by signature
+            std::vector<Combination> combinations;
+
+            std::size_t ingredientCount = 0;
+            std::uint64_t ingredientCombinations = 0;
+
+            // Combinations sharing more effects than a potion can have
+            std::uint64_t overfull = 0;
+        };
+
+        inline static std::shared_ptr<const Table> table = {};
+        inline static std::mutex tableLock;
+
+        inline static std::atomic_bool running = false;
+
+        static std::shared_ptr<Table> CollectIngredients(std::vector<Ingredient>& ingredients);
+
+        static void Enumerate(Table& result, const std::vector<Ingredient>& ingredients);
+
+        static void Report(const Table& result, const Settings::SettingsLoader::RuleSet& rules);
+
+        static Settings::SettingsLoader::EffectSignature Unpack(const Table& result, PackedSignature signature);
+
+    public:
+        Coverage() = delete;
+
+        // Enumerates the ingredient combinations across every core on a worker thread, then logs how the current
+        // rules cover them. Later calls only report again. Returns false if either is already running.
+        static bool Start();
+    };
+}
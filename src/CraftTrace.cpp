@@ -0,0 +1,131 @@
+#include "CraftTrace.h"
+
+#include "logger.h"
+#include "RenameEngine.h"
+
+namespace Diagnostics {
+    using Settings::SettingsLoader;
+
+    std::optional<std::filesystem::path> CraftTrace::GetTracePath() {
+        const auto logDirectory = SKSE::log::log_directory();
+        if (!logDirectory) {
+            return std::nullopt;
+        }
+        return *logDirectory / TRACE_FILE;
+    }
+
+    void CraftTrace::Record(const RE::AlchemyItem* alchemyItem, bool renamed) {
+        const int effectCount = alchemyItem->effects.size();
+        if (effectCount == 0 || effectCount > SettingsLoader::MAX_EFFECTS) {
+            return;
+        }
+
+        if (!recording.is_open()) {
+            const auto tracePath = GetTracePath();
+            if (!tracePath) {
+                return;
+            }
+            recording.open(*tracePath, std::ios::binary | std::ios::app);
+            if (!recording.is_open()) {
+                logger::error("Failed to open {} for recording", TRACE_FILE);
+                return;
+            }
+            if (recording.tellp() == 0) {
+                TraceFormat::WriteHeader(recording);
+            }
+            logger::info("Recording crafted potions to {}", TRACE_FILE);
+        }
+
+        TraceFormat::TracedPotion potion = {};
+        potion.effectCount = effectCount;
+        potion.renamed = renamed;
+        const auto costliestEffect = const_cast<RE::AlchemyItem*>(alchemyItem)->GetCostliestEffectItem();
+        for (int i = 0; i < effectCount; i++) {
+            const auto effect = alchemyItem->effects[i];
+            if (effect == costliestEffect) {
+                potion.costliestIndex = i;
+            }
+            potion.effects[i] = {effect->baseEffect->GetFormID(), effect->effectItem.magnitude,
+                                 effect->effectItem.duration};
+        }
+        if (renamed) {
+            potion.name = alchemyItem->GetFullName();
+        }
+        TraceFormat::WritePotion(recording, potion);
+
+        // Crafting is slow enough that every potion can go straight to disk, so nothing is lost in a crash
+        recording.flush();
+    }
+
+    bool CraftTrace::StartReplay() {
+        const auto tracePath = GetTracePath();
+        if (!tracePath || replaying.exchange(true)) {
+            return false;
+        }
+
+        std::thread([tracePath = *tracePath]() {
+            try {
+                Replay(tracePath);
+            } catch (std::exception& e) {
+                logger::error("Replay failed: {}", e.what());
+            }
+            replaying.store(false);
+        }).detach();
+        return true;
+    }
+
+    void CraftTrace::Replay(const std::filesystem::path& tracePath) {
+        using Hooks::PotencyEstimator;
+        using Hooks::PotionEngine;
+
+        const auto rules = SettingsLoader::GetSingleton()->AcquireRules();
+        if (!rules) {
+            throw std::runtime_error("Rules have not been loaded");
+        }
+
+        std::ifstream input(tracePath, std::ios::binary);
+        const auto potions = TraceFormat::Read(input, TRACE_FILE);
+
+        // Rebuild the crafted effects from the game's magic effects
+        const int potionCount = static_cast<int>(potions.size());
+        const auto effects = std::make_unique<RE::Effect[]>(potionCount * SettingsLoader::MAX_EFFECTS);
+        std::vector<RE::BSTArray<RE::Effect*>> effectLists(potionCount);
+        for (int i = 0; i < potionCount; i++) {
+            for (int j = 0; j < potions[i].effectCount; j++) {
+                const auto& traced = potions[i].effects[j];
+                auto& effect = effects[i * SettingsLoader::MAX_EFFECTS + j];
+                effect.baseEffect = RE::TESForm::LookupByID<RE::EffectSetting>(traced.effectID);
+                if (!effect.baseEffect) {
+                    throw std::runtime_error(std::format("Traced effect {:08X} is not loaded", traced.effectID));
+                }
+                effect.effectItem.magnitude = traced.magnitude;
+                effect.effectItem.duration = traced.duration;
+                effect.cost = PotencyEstimator::GetEffectCost(effect.baseEffect, traced.magnitude, traced.duration);
+                effectLists[i].push_back(&effect);
+            }
+        }
+
+        // Same steps as the rename hook, timed per potion
+        std::vector<std::optional<RE::BSFixedString>> names(potionCount);
+        const auto result = TraceFormat::Replay(
+            potions,
+            [&](int i) -> std::optional<std::string_view> {
+                const auto& costliestEffect = *effectLists[i][potions[i].costliestIndex];
+                names[i] = PotionEngine::GetName(*rules, effectLists[i], costliestEffect);
+                return names[i] ? std::optional<std::string_view>(names[i]->c_str()) : std::nullopt;
+            },
+            MAX_REPORTED_MISMATCHES);
+
+        for (const auto& mismatch : result.reportedMismatches) {
+            logger::warn("{}", mismatch);
+        }
+        logger::info(
+            "Replayed {} potions in {:.3f} ms ({:.0f} potions/s): p50 {:.0f} ns, p99 {:.0f} ns, max {:.0f} ns, "
+            "{} names differ from the recording",
+            potionCount, result.totalSeconds * 1e3, potionCount / std::max(result.totalSeconds, 1e-9),
+            result.GetPercentile(0.5), result.GetPercentile(0.99), result.GetPercentile(1.0), result.mismatches);
+        if (rules->generator) {
+            logger::info("{} generated names are cached", rules->generator->GetCachedCount());
+        }
+    }
+}
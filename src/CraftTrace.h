@@ -0,0 +1,33 @@
+#pragma once
+
+#include "SettingsLoader.h"
+#include "TraceFormat.h"
+
+namespace Diagnostics {
+    // Records crafted potions to a binary trace, and replays traces through the current rules. The trace format is
+    // in TraceFormat.h.
+    class CraftTrace {
+    private:
+        static constexpr auto TRACE_FILE = "AutoPotionRenamerCrafts.trace"sv;
+
+        // Mismatched names logged per replay
+        static constexpr int MAX_REPORTED_MISMATCHES = 20;
+
+        inline static std::ofstream recording;
+        inline static std::atomic_bool replaying = false;
+
+        static std::optional<std::filesystem::path> GetTracePath();
+
+        static void Replay(const std::filesystem::path& tracePath);
+
+    public:
+        CraftTrace() = delete;
+
+        // Appends a crafted potion and the name it was given. Called from the rename hook on the main thread.
+        static void Record(const RE::AlchemyItem* alchemyItem, bool renamed);
+
+        // Replays the trace on a worker thread, logging throughput, latency, and any names that differ from the
+        // recorded ones. Returns false if a replay is already running.
+        static bool StartReplay();
+    };
+}
@@ -0,0 +1,114 @@
+#include "EditorIDIndex.h"
+
+#include "logger.h"
+
+namespace Settings {
+    namespace {
+        // Editor IDs are ASCII, and the game compares them without case
+        char ToLower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+        bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+            return std::ranges::equal(a, b, [](char x, char y) { return ToLower(x) == ToLower(y); });
+        }
+    }
+
+    void EditorIDIndex::SetUpHook() {
+        // TESForm::SetFormEditorID, which magic effects leave empty
+        REL::Relocation<std::uintptr_t> vtable{RE::VTABLE_EffectSetting[0]};
+        _SetFormEditorID = vtable.write_vfunc(0x33, SetFormEditorID);
+    }
+
+    bool EditorIDIndex::SetFormEditorID(RE::EffectSetting* a_this, const char* a_str) {
+        if (a_str && *a_str && !built.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(capturedLock);
+            captured.emplace_back(a_this->GetFormID(), a_str);
+        }
+        return _SetFormEditorID(a_this, a_str);
+    }
+
+    void EditorIDIndex::Build() {
+        if (built.load()) {
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::pair<RE::FormID, std::string>> forms;
+        {
+            std::lock_guard lock(capturedLock);
+            forms = std::exchange(captured, {});
+        }
+
+        // An effect overridden by a later plugin is given its editor ID again; the last one loaded wins
+        std::stable_sort(forms.begin(), forms.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        const auto last = std::unique(forms.rbegin(), forms.rend(),
+                                      [](const auto& a, const auto& b) { return a.first == b.first; });
+        forms.erase(forms.begin(), last.base());
+
+        std::size_t totalLength = 0;
+        for (const auto& [formID, editorID] : forms) {
+            totalLength += editorID.size();
+        }
+        editorIDs.reserve(totalLength);
+        entries.reserve(forms.size());
+        for (const auto& [formID, editorID] : forms) {
+            entries.push_back({Hash(editorID), static_cast<std::uint32_t>(editorIDs.size()),
+                               static_cast<std::uint32_t>(editorID.size()), formID});
+            editorIDs += editorID;
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.hash != b.hash ? a.hash < b.hash : a.formID < b.formID;
+        });
+
+        reverseEntries.reserve(entries.size());
+        for (std::uint32_t i = 0; i < entries.size(); i++) {
+            reverseEntries.push_back({entries[i].formID, i});
+        }
+        std::sort(reverseEntries.begin(), reverseEntries.end(),
+                  [](const ReverseEntry& a, const ReverseEntry& b) { return a.formID < b.formID; });
+
+        built.store(true, std::memory_order_release);
+
+        const auto bytes = editorIDs.capacity() + entries.capacity() * sizeof(Entry) +
+                           reverseEntries.capacity() * sizeof(ReverseEntry);
+        logger::info("Indexed {} magic effect editor IDs in {:.2f} ms, using {} KiB", entries.size(),
+                     std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count(),
+                     bytes / 1024);
+        if (entries.empty()) {
+            logger::warn("No magic effect editor IDs were captured, effects can only be named by FormID or name");
+        }
+    }
+
+    RE::FormID EditorIDIndex::Find(std::string_view editorID) {
+        if (!built.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        const auto hash = Hash(editorID);
+        auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+                                   [](const Entry& entry, std::uint64_t value) { return entry.hash < value; });
+        for (; it != entries.end() && it->hash == hash; ++it) {
+            if (EqualsIgnoreCase(GetText(*it), editorID)) {
+                return it->formID;
+            }
+        }
+        return 0;
+    }
+
+    std::string_view EditorIDIndex::GetEditorID(RE::FormID formID) {
+        if (!built.load(std::memory_order_acquire)) {
+            return {};
+        }
+        const auto it = std::lower_bound(
+            reverseEntries.begin(), reverseEntries.end(), formID,
+            [](const ReverseEntry& entry, RE::FormID value) { return entry.formID < value; });
+        return it != reverseEntries.end() && it->formID == formID ? GetText(entries[it->entry]) : std::string_view();
+    }
+
+    std::uint64_t EditorIDIndex::Hash(std::string_view editorID) {
+        // FNV-1a over the lowercase editor ID
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const char c : editorID) {
+            hash = (hash ^ static_cast<std::uint8_t>(ToLower(c))) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
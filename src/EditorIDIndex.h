@@ -0,0 +1,57 @@
+#pragma once
+
+namespace Settings {
+    // Editor IDs of every magic effect, which the game discards once a form is loaded. They are captured as forms
+    // are loaded, then packed into a flat index at kDataLoaded that is never modified again, so it can be read from
+    // any thread.
+    class EditorIDIndex {
+    public:
+        EditorIDIndex() = delete;
+
+        // Captures editor IDs as the game loads magic effects. Must be installed before the game data is loaded.
+        static void SetUpHook();
+
+        // Packs the captured editor IDs into the index. Called once, when the game data has loaded.
+        static void Build();
+
+        // Returns the magic effect with an editor ID, ignoring case, or 0 if there is none
+        static RE::FormID Find(std::string_view editorID);
+
+        // Returns a magic effect's editor ID, or an empty string if it has none
+        static std::string_view GetEditorID(RE::FormID formID);
+
+    private:
+        // Sorted by hash, then by editor ID
+        struct Entry {
+            std::uint64_t hash;
+            std::uint32_t offset;  // Into editorIDs
+            std::uint32_t length;
+            RE::FormID formID;
+        };
+
+        // Sorted by formID
+        struct ReverseEntry {
+            RE::FormID formID;
+            std::uint32_t entry;  // Into entries
+        };
+
+        static bool SetFormEditorID(RE::EffectSetting* a_this, const char* a_str);
+
+        inline static REL::Relocation<decltype(&EditorIDIndex::SetFormEditorID)> _SetFormEditorID;
+
+        // Captured while the game data is loading, then released by Build
+        inline static std::vector<std::pair<RE::FormID, std::string>> captured = {};
+        inline static std::mutex capturedLock;
+
+        inline static std::atomic_bool built = false;
+
+        // Every editor ID, back to back
+        inline static std::string editorIDs = {};
+        inline static std::vector<Entry> entries = {};
+        inline static std::vector<ReverseEntry> reverseEntries = {};
+
+        static std::uint64_t Hash(std::string_view editorID);
+
+        static std::string_view GetText(const Entry& entry) { return {editorIDs.data() + entry.offset, entry.length}; }
+    };
+}
@@ -0,0 +1,39 @@
+#include "EnchantmentRenamer.h"
+
+#include "BatchRenamer.h"
+
+namespace Hooks {
+    using Settings::SettingsLoader;
+
+    EnchantmentRenamer* EnchantmentRenamer::GetSingleton() {
+        static EnchantmentRenamer singleton;
+        return &singleton;
+    }
+
+    void EnchantmentRenamer::Register() {
+        RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(GetSingleton());
+    }
+
+    RE::BSEventNotifyControl EnchantmentRenamer::ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                                              RE::BSTEventSource<RE::MenuOpenCloseEvent>*) {
+        if (!a_event || a_event->menuName != RE::CraftingMenu::MENU_NAME) {
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        // The same menu is used for alchemy, smithing and tanning, but enchantments are only created at an enchanting
+        // table. Its sub-menu is created with the menu, so it is checked on the frame after the menu opens.
+        if (a_event->opening) {
+            SKSE::GetTaskInterface()->AddTask(CheckSubMenu);
+        } else if (enchanting.exchange(false)) {
+            BatchRenamer::Start(SettingsLoader::ItemKind::Enchantment);
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    void EnchantmentRenamer::CheckSubMenu() {
+        const auto menu = RE::UI::GetSingleton()->GetMenu<RE::CraftingMenu>();
+        if (menu && menu->subMenu && skyrim_cast<RE::CraftingSubMenus::EnchantConstructMenu*>(menu->subMenu)) {
+            enchanting.store(true);
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+namespace Hooks {
+    // Renames player-made enchantments with the rules from "enchantments", once the crafting menu they were made in
+    // is closed. The renaming itself is done by BatchRenamer, away from the main thread and within its frame budget.
+    class EnchantmentRenamer : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+    private:
+        // Whether the open crafting menu is an enchanting table
+        inline static std::atomic_bool enchanting = false;
+
+        static void CheckSubMenu();
+
+        RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                              RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_eventSource) override;
+
+    public:
+        static EnchantmentRenamer* GetSingleton();
+
+        static void Register();
+    };
+}
@@ -0,0 +1,77 @@
+#include "FormResolver.h"
+
+#include "EditorIDIndex.h"
+#include "logger.h"
+#include "Utils.h"
+
+namespace Settings {
+    void FormResolver::Resolve() {
+        const auto dataHandler = RE::TESDataHandler::GetSingleton();
+        if (!dataHandler) {
+            logger::error("Data handler not found");
+            return;
+        }
+
+        for (auto& [identifier, form] : forms) {
+            // "Plugin.esp|BEEF0" names a form ID, anything without a '|' is an editor ID
+            const auto separator = identifier.find('|');
+            if (separator == std::string_view::npos) {
+                // Magic effects come from the plugin's own index, as the game does not keep their editor IDs
+                const auto effectID = EditorIDIndex::Find(identifier);
+                form = effectID ? RE::TESForm::LookupByID(effectID) : RE::TESForm::LookupByEditorID(identifier);
+            } else if (identifier.find('|', separator + 1) == std::string_view::npos) {
+                form = ResolveFormID(dataHandler, identifier.substr(0, separator), identifier.substr(separator + 1));
+            }
+        }
+        logger::info("Resolved {} distinct effect identifiers from {} plugins", forms.size(), plugins.size());
+    }
+
+    RE::TESForm* FormResolver::Find(std::string_view identifier) const {
+        const auto it = forms.find(identifier);
+        return it != forms.end() ? it->second : nullptr;
+    }
+
+    std::expected<FormID, std::string> FormResolver::FindEffect(std::string_view identifier) const {
+        const auto form = Find(identifier);
+        if (!form) {
+            return std::unexpected(std::format("Failed to load ID \"{}\"", identifier));
+        }
+        if (!form->Is(RE::FormType::MagicEffect)) {
+            return std::unexpected(std::format("Form {} was loaded as \"{}\", which is not an alchemy effect",
+                                               Utils::GetHexString(form->formID), form->GetName()));
+        }
+        return form->formID;
+    }
+
+    RE::TESForm* FormResolver::ResolveFormID(RE::TESDataHandler* dataHandler, std::string_view plugin,
+                                             std::string_view id) {
+        if (id.starts_with("0x") || id.starts_with("0X")) {
+            id.remove_prefix(2);
+        }
+        RE::FormID rawFormID = 0;
+        const auto [end, error] = std::from_chars(id.data(), id.data() + id.size(), rawFormID, 16);
+        if (error != std::errc() || end != id.data() + id.size()) {
+            return nullptr;
+        }
+
+        auto [cached, inserted] = plugins.try_emplace(plugin, nullptr);
+        if (inserted) {
+            cached->second = dataHandler->LookupModByName(plugin);
+        }
+        const auto file = cached->second;
+        if (!file) {
+            return nullptr;
+        }
+
+        // The same load order arithmetic as TESDataHandler::LookupForm, without searching for the plugin again
+        RE::FormID formID;
+        if (file->IsLight()) {
+            const RE::FormID smallFileIndex = file->GetSmallFileCompileIndex();
+            formID = 0xFE000000 | (smallFileIndex << 12) | (rawFormID & 0xFFF);
+        } else {
+            const RE::FormID fileIndex = file->GetCompileIndex();
+            formID = (fileIndex << 24) | (rawFormID & 0xFFFFFF);
+        }
+        return RE::TESForm::LookupByID(formID);
+    }
+}
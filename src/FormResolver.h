@@ -0,0 +1,31 @@
+#pragma once
+
+#include "FormSource.h"
+
+namespace Settings {
+    static_assert(std::is_same_v<FormID, RE::FormID>, "The core library's formIDs must be the game's");
+
+    // Resolves the effect identifiers used in potion files through the data handler, looking each distinct
+    // identifier up only once
+    class FormResolver : public FormSource {
+    public:
+        void Add(std::string_view identifier) override { forms.try_emplace(identifier, nullptr); }
+
+        // Must run on the main thread, as it reads forms through the data handler. Reloads hand it over to the main
+        // thread and wait for it.
+        void Resolve() override;
+
+        std::expected<FormID, std::string> FindEffect(std::string_view identifier) const override;
+
+        // Returns the form for an identifier passed to Add, or nullptr if it could not be found
+        RE::TESForm* Find(std::string_view identifier) const;
+
+    private:
+        std::unordered_map<std::string_view, RE::TESForm*> forms = {};
+
+        // Plugins by file name, so that each is only searched for once
+        std::unordered_map<std::string_view, const RE::TESFile*> plugins = {};
+
+        RE::TESForm* ResolveFormID(RE::TESDataHandler* dataHandler, std::string_view plugin, std::string_view id);
+    };
+}
@@ -0,0 +1,83 @@
+#include "NameGenerator.h"
+
+#include "NameFormat.h"
+
+namespace Settings {
+    std::size_t NameGenerator::KeyHash::operator()(const Key& key) const noexcept {
+        // FNV-1a over the formIDs, in order
+        std::size_t hash = 14695981039346656037ull;
+        for (int i = 0; i < key.effectCount; i++) {
+            hash = (hash ^ key.effectIDs[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::shared_ptr<const NameGenerator::GeneratedPotion> NameGenerator::Generate(
+        std::span<RE::Effect* const> effects, const SettingsLoader::RuleSet& rules) const {
+        const int effectCount = static_cast<int>(effects.size());
+        if (effectCount > SettingsLoader::MAX_EFFECTS || templates[effectCount].empty()) {
+            return nullptr;
+        }
+
+        // Costliest first, by formID on a tie so that the order is always the same
+        std::array<const RE::Effect*, SettingsLoader::MAX_EFFECTS> ordered = {};
+        std::copy(effects.begin(), effects.end(), ordered.begin());
+        std::sort(ordered.begin(), ordered.begin() + effectCount, [](const RE::Effect* a, const RE::Effect* b) {
+            return a->cost != b->cost ? a->cost > b->cost : a->baseEffect->GetFormID() < b->baseEffect->GetFormID();
+        });
+        Key key;
+        key.effectCount = effectCount;
+        for (int i = 0; i < effectCount; i++) {
+            key.effectIDs[i] = ordered[i]->baseEffect->GetFormID();
+        }
+
+        {
+            std::lock_guard lock(cacheLock);
+            if (const auto it = cache.find(key); it != cache.end()) {
+                recent.splice(recent.begin(), recent, it->second);
+                return it->second->second;
+            }
+        }
+
+        // Built outside the lock; if another thread built the same name meanwhile, the first one is kept
+        auto generated = Build(key, rules);
+
+        std::lock_guard lock(cacheLock);
+        const auto [it, inserted] = cache.try_emplace(key);
+        if (!inserted) {
+            recent.splice(recent.begin(), recent, it->second);
+            return it->second->second;
+        }
+        recent.emplace_front(key, generated);
+        it->second = recent.begin();
+        if (cache.size() > capacity) {
+            cache.erase(recent.back().first);
+            recent.pop_back();
+        }
+        return generated;
+    }
+
+    std::shared_ptr<const NameGenerator::GeneratedPotion> NameGenerator::Build(
+        const Key& key, const SettingsLoader::RuleSet& rules) const {
+        const std::span<const RE::FormID> orderedIDs(key.effectIDs.data(), key.effectCount);
+        auto name = NameTemplate::Expand(templates[key.effectCount], orderedIDs, fragments);
+        if (name.empty()) {
+            return nullptr;
+        }
+
+        auto generated = std::make_shared<GeneratedPotion>();
+        generated->name = std::move(name);
+        const auto format = NameFormat::GetDescriptorFormat(generated->name);
+        for (const auto& rendered : SettingsLoader::RenderNames(rules, generated->name, format, descriptorIndex)) {
+            generated->names.emplace_back(rendered);
+        }
+        generated->potion = {key.effectIDs.data(), generated->name, format, key.effectCount, descriptorIndex};
+        generated->potion.names = generated->names;
+        return generated;
+    }
+
+    std::size_t NameGenerator::GetCachedCount() const {
+        std::lock_guard lock(cacheLock);
+        return cache.size();
+    }
+}
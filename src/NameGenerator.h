@@ -0,0 +1,58 @@
+#pragma once
+
+#include "NameTemplate.h"
+#include "SettingsLoader.h"
+
+namespace Settings {
+    // Names potions that no rule matches from per-effect fragments, e.g. "{}{noun1} of {adjective2}", where 1 is the
+    // costliest effect. A name is generated the first time a combination of effects is crafted, then kept in a
+    // bounded cache, so memory follows the combinations that are actually crafted.
+    class NameGenerator {
+    public:
+        using Fragment = NameTemplate::Fragment;
+
+        // A generated potion, with every name it can be given rendered the same way as a rule's
+        struct GeneratedPotion {
+            std::string name;
+            std::vector<RE::BSFixedString> names = {};
+            SettingsLoader::CustomPotion potion = {};
+        };
+
+        static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+
+        // Templates by effect count, empty where there is none
+        std::array<std::string, SettingsLoader::MAX_EFFECTS + 1> templates = {};
+        NameTemplate::FragmentMap fragments = {};
+        int descriptorIndex = -1;
+        std::size_t capacity = DEFAULT_CAPACITY;
+
+        // Returns the potion generated for these effects, or nullptr if there is no template for this many effects
+        // or one of them has no fragment. Safe to call from any thread.
+        std::shared_ptr<const GeneratedPotion> Generate(std::span<RE::Effect* const> effects,
+                                                        const SettingsLoader::RuleSet& rules) const;
+
+        std::size_t GetCachedCount() const;
+
+    private:
+        // Effects in cost order, so that the same effects crafted at different strengths can be named differently
+        struct Key {
+            std::array<RE::FormID, SettingsLoader::MAX_EFFECTS> effectIDs = {};
+            int effectCount = 0;
+
+            bool operator==(const Key& other) const = default;
+        };
+
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const noexcept;
+        };
+
+        // Most recently used first; nullptr entries remember combinations that cannot be named
+        using RecentList = std::list<std::pair<Key, std::shared_ptr<const GeneratedPotion>>>;
+
+        mutable std::mutex cacheLock;
+        mutable RecentList recent = {};
+        mutable std::unordered_map<Key, RecentList::iterator, KeyHash> cache = {};
+
+        std::shared_ptr<const GeneratedPotion> Build(const Key& key, const SettingsLoader::RuleSet& rules) const;
+    };
+}
@@ -0,0 +1,238 @@
+#include "NamePreview.h"
+
+#include "AsyncLog.h"
+#include "logger.h"
+#include "RenameEngine.h"
+
+namespace Hooks {
+    using Settings::SettingsLoader;
+
+    NamePreview* NamePreview::GetSingleton() {
+        static NamePreview singleton;
+        return &singleton;
+    }
+
+    void NamePreview::Register() {
+        const auto inputManager = RE::BSInputDeviceManager::GetSingleton();
+        if (!inputManager) {
+            logger::error("Failed to register the name preview, the input manager is not ready");
+            return;
+        }
+        inputManager->AddEventSink<RE::InputEvent*>(GetSingleton());
+        RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(GetSingleton());
+        logger::info("Registered the alchemy menu name preview");
+    }
+
+    void NamePreview::Reset() {
+        lastSelection = {};
+        pendingName = std::nullopt;
+        shownName = std::nullopt;
+    }
+
+    RE::BSEventNotifyControl NamePreview::ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                                       RE::BSTEventSource<RE::MenuOpenCloseEvent>*) {
+        // Each visit to the menu starts afresh, so the first selection is shown even if it repeats the last name
+        if (a_event && !a_event->opening && a_event->menuName == RE::CraftingMenu::MENU_NAME) {
+            SKSE::GetTaskInterface()->AddTask(Reset);
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl NamePreview::ProcessEvent(RE::InputEvent* const* a_event,
+                                                       RE::BSTEventSource<RE::InputEvent*>*) {
+        if (!a_event || !RE::UI::GetSingleton()->IsMenuOpen(RE::CraftingMenu::MENU_NAME)) {
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        for (auto event = *a_event; event; event = event->next) {
+            const auto button = event->AsButtonEvent();
+            if (button && button->IsDown()) {
+                // Checked once the menu has handled the input, as it is what changes the selection
+                if (!checkQueued.exchange(true)) {
+                    SKSE::GetTaskInterface()->AddTask(CheckSelection);
+                }
+                break;
+            }
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::CraftingSubMenus::AlchemyMenu* NamePreview::GetAlchemyMenu() {
+        const auto menu = RE::UI::GetSingleton()->GetMenu<RE::CraftingMenu>();
+        if (!menu || !menu->subMenu) {
+            return nullptr;
+        }
+        return skyrim_cast<RE::CraftingSubMenus::AlchemyMenu*>(menu->subMenu);
+    }
+
+    void NamePreview::CheckSelection() {
+        checkQueued.store(false);
+
+        const auto rules = SettingsLoader::GetSingleton()->GetRules();
+        const auto alchemyMenu = GetAlchemyMenu();
+        if (!rules || !rules->namePreview || !alchemyMenu) {
+            return;
+        }
+
+        std::array<RE::IngredientItem*, MAX_INGREDIENTS> selection = {};
+        int ingredientCount = 0;
+        for (const auto& entry : alchemyMenu->ingredientEntries) {
+            if (!entry.isSelected || !entry.ingredient || !entry.ingredient->object) {
+                continue;
+            }
+            if (const auto ingredient = entry.ingredient->object->As<RE::IngredientItem>()) {
+                if (ingredientCount < MAX_INGREDIENTS) {
+                    selection[ingredientCount++] = ingredient;
+                }
+            }
+        }
+        if (selection == lastSelection) {
+            return;
+        }
+        lastSelection = selection;
+
+        std::optional<RE::BSFixedString> name;
+        const auto start = std::chrono::steady_clock::now();
+        if (ingredientCount >= 2) {
+            name = Preview(*rules, {selection.data(), static_cast<std::size_t>(ingredientCount)}, GetAlchemyPower(),
+                           RE::PlayerCharacter::GetSingleton());
+            APR_DEBUG("Previewed {} ingredients in {:.1f} us", ingredientCount,
+                      std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        // Replaces any name still waiting, so only the selection the player settles on is shown
+        pendingName = name;
+        pendingSince = start;
+        if (!showQueued) {
+            showQueued = true;
+            SKSE::GetTaskInterface()->AddTask(ShowPending);
+        }
+    }
+
+    void NamePreview::ShowPending() {
+        if (!GetAlchemyMenu()) {
+            showQueued = false;
+            Reset();
+            return;
+        }
+
+        // Tasks queued while the task queue is running are run on the next frame
+        if (std::chrono::steady_clock::now() - pendingSince < SHOW_DELAY) {
+            SKSE::GetTaskInterface()->AddTask(ShowPending);
+            return;
+        }
+        showQueued = false;
+
+        if (pendingName && pendingName != shownName) {
+            RE::DebugNotification(pendingName->c_str());
+        }
+        shownName = std::exchange(pendingName, std::nullopt);
+    }
+
+    float NamePreview::GetAlchemyPower() {
+        const auto player = RE::PlayerCharacter::GetSingleton();
+        const auto gameSettings = RE::GameSettingCollection::GetSingleton();
+        const auto getSetting = [gameSettings](const char* name, float fallback) {
+            const auto setting = gameSettings ? gameSettings->GetSetting(name) : nullptr;
+            return setting ? setting->GetFloat() : fallback;
+        };
+
+        const float skill = player->AsActorValueOwner()->GetActorValue(RE::ActorValue::kAlchemy);
+        const float fortify = player->AsActorValueOwner()->GetActorValue(RE::ActorValue::kAlchemyModifier);
+        const float skillFactor = getSetting("fAlchemySkillFactor", 1.5f);
+        return getSetting("fAlchemyIngredientInitMult", 4.0f) * (1.0f + (skillFactor - 1.0f) * skill / 100.0f) *
+               (1.0f + fortify / 100.0f);
+    }
+
+    std::optional<RE::BSFixedString> NamePreview::Preview(const SettingsLoader::RuleSet& rules,
+                                                          std::span<RE::IngredientItem* const> ingredients,
+                                                          float power, RE::Actor* alchemist) {
+        using EffectFlag = RE::EffectSetting::EffectSettingData::Flag;
+        using EntryPoint = RE::BGSEntryPoint::ENTRY_POINT;
+
+        // Effects found in at least two ingredients, using the strongest ingredient's version of each
+        RE::Effect* strongest[MAX_CANDIDATE_EFFECTS] = {};
+        float strongestCost[MAX_CANDIDATE_EFFECTS] = {};
+        int shareCount[MAX_CANDIDATE_EFFECTS] = {};
+        int candidateCount = 0;
+        for (const auto ingredient : ingredients) {
+            for (const auto effect : ingredient->effects) {
+                if (!effect || !effect->baseEffect) {
+                    continue;
+                }
+                const float cost = PotencyEstimator::GetEffectCost(effect->baseEffect, effect->effectItem.magnitude,
+                                                                   effect->effectItem.duration);
+                int i = 0;
+                while (i < candidateCount && strongest[i]->baseEffect != effect->baseEffect) {
+                    i++;
+                }
+                if (i == candidateCount) {
+                    if (candidateCount == MAX_CANDIDATE_EFFECTS) {
+                        continue;
+                    }
+                    candidateCount++;
+                } else if (strongestCost[i] >= cost) {
+                    shareCount[i]++;
+                    continue;
+                }
+                strongest[i] = effect;
+                strongestCost[i] = cost;
+                shareCount[i]++;
+            }
+        }
+
+        RE::Effect effects[SettingsLoader::MAX_EFFECTS];
+        RE::Effect* effectPointers[SettingsLoader::MAX_EFFECTS] = {};
+        int effectCount = 0;
+        int costliestIndex = 0;
+        for (int i = 0; i < candidateCount; i++) {
+            if (shareCount[i] < 2) {
+                continue;
+            }
+            if (effectCount == SettingsLoader::MAX_EFFECTS) {
+                return std::nullopt;  // Too many effects for any rule to match
+            }
+
+            auto& effect = effects[effectCount];
+            const auto baseEffect = strongest[i]->baseEffect;
+            effect.baseEffect = baseEffect;
+            effect.effectItem = strongest[i]->effectItem;
+            // Perks such as Alchemist, Physician and Benefactor are conditioned on the effect, so each is checked
+            // through the game's entry points rather than folded into the power
+            if (baseEffect->data.flags.any(EffectFlag::kPowerAffectsMagnitude)) {
+                float magnitude = effect.effectItem.magnitude * power;
+                if (alchemist) {
+                    RE::BGSEntryPoint::HandleEntryPoint(EntryPoint::kModifyAlchemyPotionMagnitude, alchemist,
+                                                        baseEffect, &magnitude);
+                }
+                effect.effectItem.magnitude = std::round(magnitude);
+            }
+            if (baseEffect->data.flags.any(EffectFlag::kPowerAffectsDuration)) {
+                float duration = static_cast<float>(effect.effectItem.duration) * power;
+                if (alchemist) {
+                    RE::BGSEntryPoint::HandleEntryPoint(EntryPoint::kModifyAlchemyPotionDuration, alchemist,
+                                                        baseEffect, &duration);
+                }
+                effect.effectItem.duration = static_cast<std::uint32_t>(std::round(std::max(duration, 0.0f)));
+            }
+            effect.cost =
+                PotencyEstimator::GetEffectCost(baseEffect, effect.effectItem.magnitude, effect.effectItem.duration);
+            if (effect.cost > effects[costliestIndex].cost) {
+                costliestIndex = effectCount;
+            }
+            effectPointers[effectCount++] = &effect;
+        }
+        if (effectCount == 0) {
+            return std::nullopt;
+        }
+
+        // Only rules are previewed, as their names are rendered when the rules are built. Generating a name takes the
+        // generator's lock and may allocate, which the menu should not wait on.
+        const std::span<RE::Effect* const> effectSpan{effectPointers, static_cast<std::size_t>(effectCount)};
+        const auto rule = PotionEngine::FindRule(rules, effectSpan);
+        if (!rule) {
+            return std::nullopt;
+        }
+        return rule->GetName(PotencyEstimator::EstimatePotency(effectSpan, effects[costliestIndex], rules));
+    }
+}
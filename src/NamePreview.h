@@ -0,0 +1,65 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+namespace Hooks {
+    // Shows the name a potion will be given while its ingredients are being chosen in the alchemy menu
+    class NamePreview : public RE::BSTEventSink<RE::InputEvent*>, public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+    private:
+        // Selected ingredients, as the vanilla menu allows at most three
+        static constexpr int MAX_INGREDIENTS = 3;
+
+        // Every effect of every selected ingredient
+        static constexpr int MAX_CANDIDATE_EFFECTS = MAX_INGREDIENTS * Settings::SettingsLoader::MAX_EFFECTS;
+
+        // How long the selection must stay the same before its name is shown, so that quickly picking several
+        // ingredients shows only the final one instead of queueing a notification for each
+        static constexpr auto SHOW_DELAY = std::chrono::milliseconds(250);
+
+        // The selection the current preview was made for, so that repeated clicks do not recompute it
+        inline static std::array<RE::IngredientItem*, MAX_INGREDIENTS> lastSelection = {};
+
+        // Name previewed for the latest selection, waiting for SHOW_DELAY to pass. Only used on the main thread.
+        inline static std::optional<RE::BSFixedString> pendingName = std::nullopt;
+        inline static std::chrono::steady_clock::time_point pendingSince = {};
+        inline static bool showQueued = false;
+
+        // The name shown last, so that going back to the same name is not shown twice
+        inline static std::optional<RE::BSFixedString> shownName = std::nullopt;
+
+        inline static std::atomic_bool checkQueued = false;
+
+        RE::BSEventNotifyControl ProcessEvent(RE::InputEvent* const* a_event,
+                                              RE::BSTEventSource<RE::InputEvent*>* a_eventSource) override;
+
+        RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                              RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_eventSource) override;
+
+        // Forgets the selection and the names of the last visit to the menu
+        static void Reset();
+
+        static RE::CraftingSubMenus::AlchemyMenu* GetAlchemyMenu();
+
+        static void CheckSelection();
+
+        // Shows the pending name once the selection has settled, checking again every frame until then
+        static void ShowPending();
+
+        // Power applied to ingredient magnitudes and durations by the player's skill and Fortify Alchemy. Perks are
+        // applied to each effect by Preview.
+        static float GetAlchemyPower();
+
+    public:
+        static NamePreview* GetSingleton();
+
+        static void Register();
+
+        // Returns the name a rule would give a potion crafted from these ingredients, or nothing if no rule matches.
+        // Combines the effects shared by two or more ingredients the way the game does, into buffers on the stack,
+        // and neither allocates nor takes a lock.
+        // The alchemist's perks that modify potion magnitude and duration are applied to each effect, if given.
+        static std::optional<RE::BSFixedString> Preview(const Settings::SettingsLoader::RuleSet& rules,
+                                                        std::span<RE::IngredientItem* const> ingredients,
+                                                        float power, RE::Actor* alchemist = nullptr);
+    };
+}
@@ -4,6 +4,10 @@
 
 #include "RE/Skyrim.h"
 #include "SKSE/SKSE.h"
-#include "json/json.h"
+
+#include <execution>
+#include <expected>
+#include <future>
+#include <memory_resource>
 
 using namespace std::literals;
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "Profiler.h"
+
+#ifdef APR_PROFILING
+
+    #include "logger.h"
+
+namespace Diagnostics {
+    using Settings::SettingsLoader;
+
+    void Profiler::Init() {
+        startTime = std::chrono::steady_clock::now();
+        startCycles = __rdtsc();
+    }
+
+    Profiler::ThreadHistograms& Profiler::GetThreadHistograms() {
+        thread_local ThreadHistograms* histograms = nullptr;
+        if (!histograms) {
+            std::lock_guard lock(threadsLock);
+            histograms = threads.emplace_back(std::make_unique<ThreadHistograms>()).get();
+        }
+        return *histograms;
+    }
+
+    void Profiler::Record(Stage stage, std::uint64_t cycles) {
+        auto& histograms = GetThreadHistograms();
+        const int index = static_cast<int>(stage);
+
+        // Single writer, so a relaxed load and store is enough
+        auto& bucket = histograms.buckets[index][std::bit_width(cycles)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        auto& max = histograms.max[index];
+        if (cycles > max.load(std::memory_order_relaxed)) {
+            max.store(cycles, std::memory_order_relaxed);
+        }
+    }
+
+    void Profiler::RecordHit(const SettingsLoader::RuleSet& rules, const SettingsLoader::CustomPotion* potion) {
+        rules.potionHits[potion - rules.potions.data()].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Profiler::RecordLoad(const std::string& fileName, std::chrono::steady_clock::duration duration) {
+        std::lock_guard lock(loadsLock);
+        loadMilliseconds[fileName] = std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    double Profiler::GetNanosecondsPerCycle() {
+        const auto cycles = __rdtsc() - startCycles;
+        const auto nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime);
+        return cycles > 0 ? nanoseconds.count() / cycles : 0.0;
+    }
+
+    std::vector<std::string> Profiler::Dump() {
+        std::vector<std::string> lines;
+        const double nanosecondsPerCycle = GetNanosecondsPerCycle();
+
+        // Merge every thread's histograms
+        std::uint64_t buckets[STAGE_COUNT][BUCKET_COUNT] = {};
+        std::uint64_t max[STAGE_COUNT] = {};
+        {
+            std::lock_guard lock(threadsLock);
+            for (const auto& histograms : threads) {
+                for (int stage = 0; stage < STAGE_COUNT; stage++) {
+                    for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+                        buckets[stage][bucket] += histograms->buckets[stage][bucket].load(std::memory_order_relaxed);
+                    }
+                    max[stage] = std::max(max[stage], histograms->max[stage].load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+        for (int stage = 0; stage < STAGE_COUNT; stage++) {
+            std::uint64_t count = 0;
+            for (const auto bucketCount : buckets[stage]) {
+                count += bucketCount;
+            }
+
+            // Percentiles are reported as the upper bound of the bucket they fall in
+            const auto percentile = [&](double fraction) {
+                const auto target = static_cast<std::uint64_t>(std::ceil(fraction * count));
+                std::uint64_t seen = 0;
+                for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+                    seen += buckets[stage][bucket];
+                    if (seen >= target) {
+                        return std::ldexp(nanosecondsPerCycle, bucket);
+                    }
+                }
+                return 0.0;
+            };
+            lines.push_back(std::format("{}: {} calls, p50 < {:.0f} ns, p99 < {:.0f} ns, max {:.0f} ns",
+                                        STAGE_NAMES[stage], count, count ? percentile(0.5) : 0.0,
+                                        count ? percentile(0.99) : 0.0, max[stage] * nanosecondsPerCycle));
+        }
+
+        // Hits are counted per rule set, so a reload starts them again from zero
+        if (const auto rules = SettingsLoader::GetSingleton()->AcquireRules()) {
+            std::vector<std::pair<std::uint64_t, int>> hits;
+            std::uint64_t totalHits = 0;
+            for (int i = 0; i < (int)rules->potions.size(); i++) {
+                const auto count = rules->potionHits[i].load(std::memory_order_relaxed);
+                if (count > 0) {
+                    hits.emplace_back(count, i);
+                    totalHits += count;
+                }
+            }
+            const auto reported = hits.begin() + std::min<std::size_t>(hits.size(), REPORTED_RULES);
+            std::partial_sort(hits.begin(), reported, hits.end(), std::greater{});
+
+            lines.push_back(std::format("{} crafts matched {} of {} rules, {} matched none", totalHits, hits.size(),
+                                        rules->potions.size(), misses.load(std::memory_order_relaxed)));
+            for (auto it = hits.begin(); it != reported; ++it) {
+                lines.push_back(std::format("  {} x \"{}\"", it->first, rules->potions[it->second].name));
+            }
+        }
+
+        for (const auto& line : lines) {
+            logger::info("{}", line);
+        }
+
+        // File load times can run to hundreds of lines, so they only go to the log
+        std::lock_guard lock(loadsLock);
+        for (const auto& [fileName, milliseconds] : loadMilliseconds) {
+            logger::info("Loaded {} in {:.2f} ms", fileName, milliseconds);
+        }
+        return lines;
+    }
+}
+
+#endif
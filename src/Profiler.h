@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+// Timing counters for the rename hook. Built only when APR_PROFILING is defined (the APR_PROFILING CMake option);
+// otherwise the macros below expand to nothing and none of this is compiled.
+#ifdef APR_PROFILING
+
+    #include <intrin.h>
+
+namespace Diagnostics {
+    class Profiler {
+    public:
+        enum class Stage : std::uint8_t {
+            AddForm,  // The game's own _AddForm call
+            Match,
+            Potency,
+            Format,  // Picking the pre-rendered name
+            Assign,  // Writing it to the potion
+            Count
+        };
+
+        // Times consecutive stages of one call, each measured from the end of the previous one
+        class LapTimer {
+        public:
+            void Lap(Stage stage) {
+                Record(stage, __rdtsc() - last);
+                last = __rdtsc();
+            }
+
+        private:
+            std::uint64_t last = __rdtsc();
+        };
+
+        Profiler() = delete;
+
+        // Calibrates the cycle counter against the system clock. Called once when the plugin loads.
+        static void Init();
+
+        static void Record(Stage stage, std::uint64_t cycles);
+
+        static void RecordHit(const Settings::SettingsLoader::RuleSet& rules,
+                              const Settings::SettingsLoader::CustomPotion* potion);
+
+        static void RecordMiss() { misses.fetch_add(1, std::memory_order_relaxed); }
+
+        // Time taken to read one input file while building rules
+        static void RecordLoad(const std::string& fileName, std::chrono::steady_clock::duration duration);
+
+        // Logs stage latencies, the most used rules and file load times, and returns a short summary for the console
+        static std::vector<std::string> Dump();
+
+    private:
+        static constexpr int STAGE_COUNT = static_cast<int>(Stage::Count);
+        static constexpr const char* STAGE_NAMES[STAGE_COUNT] = {"addForm", "match", "potency", "format", "assign"};
+
+        // Bucket n holds calls that took less than 2^n cycles
+        static constexpr int BUCKET_COUNT = 65;
+
+        // Rules listed by Dump
+        static constexpr int REPORTED_RULES = 10;
+
+        // Only the owning thread writes to its histograms, so recording never contends
+        struct ThreadHistograms {
+            std::atomic<std::uint64_t> buckets[STAGE_COUNT][BUCKET_COUNT] = {};
+            std::atomic<std::uint64_t> max[STAGE_COUNT] = {};
+        };
+
+        inline static std::uint64_t startCycles = 0;
+        inline static std::chrono::steady_clock::time_point startTime = {};
+
+        inline static std::atomic<std::uint64_t> misses = 0;
+
+        // Every thread that has recorded a stage; only locked when a thread records its first stage, or by Dump
+        inline static std::mutex threadsLock;
+        inline static std::vector<std::unique_ptr<ThreadHistograms>> threads = {};
+
+        inline static std::mutex loadsLock;
+        inline static std::map<std::string, double> loadMilliseconds = {};
+
+        static ThreadHistograms& GetThreadHistograms();
+
+        static double GetNanosecondsPerCycle();
+    };
+}
+
+    #define APR_PROFILE_BEGIN(timer) Diagnostics::Profiler::LapTimer timer
+    #define APR_PROFILE_LAP(timer, stage) timer.Lap(Diagnostics::Profiler::Stage::stage)
+    #define APR_PROFILE_TIMER(timer) (&(timer))
+    #define APR_PROFILE_HIT(rules, potion) Diagnostics::Profiler::RecordHit(rules, potion)
+    #define APR_PROFILE_MISS() Diagnostics::Profiler::RecordMiss()
+    #define APR_PROFILE_LOAD(fileName, start) \
+        Diagnostics::Profiler::RecordLoad(fileName, std::chrono::steady_clock::now() - (start))
+
+#else
+
+    #define APR_PROFILE_BEGIN(timer)
+    #define APR_PROFILE_LAP(timer, stage) ((void)0)
+    #define APR_PROFILE_TIMER(timer) nullptr
+    #define APR_PROFILE_HIT(rules, potion) ((void)0)
+    #define APR_PROFILE_MISS() ((void)0)
+    #define APR_PROFILE_LOAD(fileName, start) ((void)0)
+
+#endif
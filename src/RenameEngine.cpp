@@ -0,0 +1,19 @@
+#include "RenameEngine.h"
+
+namespace Hooks {
+    float PotencyEstimator::EstimatePotency(std::span<RE::Effect* const> effects, const RE::Effect& costliestEffect,
+                                            const Settings::SettingsLoader::RuleSet& rules) {
+        using Settings::SettingsLoader;
+
+        if (rules.potencies.aggregation == Settings::PotencyAggregation::Costliest) {
+            return rules.potencies.EstimateEffect(Copy(costliestEffect));
+        }
+
+        Settings::CraftedEffect crafted[SettingsLoader::MAX_EFFECTS] = {};
+        const int effectCount = std::min<int>(effects.size(), SettingsLoader::MAX_EFFECTS);
+        for (int i = 0; i < effectCount; i++) {
+            crafted[i] = Copy(*effects[i]);
+        }
+        return rules.potencies.Estimate({crafted, static_cast<std::size_t>(effectCount)}, Copy(costliestEffect));
+    }
+}
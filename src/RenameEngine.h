@@ -0,0 +1,178 @@
+#pragma once
+
+#include "AsyncLog.h"
+#include "NameGenerator.h"
+#include "Profiler.h"
+#include "SettingsLoader.h"
+
+namespace Hooks {
+#ifdef APR_PROFILING
+    using RenameTimer = Diagnostics::Profiler::LapTimer;
+#else
+    // Stands in for the profiler's lap timer, which is only built with APR_PROFILING
+    struct RenameTimer {};
+#endif
+
+    // What RenameEngine::Rename did with an item
+    struct RenameResult {
+        // The rule that named it, or nullptr if it was given a generated name or kept its own
+        const Settings::SettingsLoader::CustomPotion* rule = nullptr;
+        bool renamed = false;
+    };
+
+    // Potency estimation, shared by every item kind since it only looks at the effects. The estimate itself is made
+    // by the core library's PotencyTable, from copies of the game's effects.
+    class PotencyEstimator {
+    public:
+        PotencyEstimator() = delete;
+
+        // Copies what the potency table reads out of a game effect
+        static Settings::CraftedEffect Copy(const RE::Effect& effect) {
+            return {effect.baseEffect->GetFormID(), effect.effectItem.magnitude, effect.effectItem.duration,
+                    effect.cost, Settings::SettingsLoader::GetPotencyDriver(effect.baseEffect)};
+        }
+
+        // Potency of a crafted item between 0 and 1, combining its effects as set by potencyAggregation
+        static float EstimatePotency(std::span<RE::Effect* const> effects, const RE::Effect& costliestEffect,
+                                     const Settings::SettingsLoader::RuleSet& rules);
+
+        // The game's spell cost formula, for effects that were not created by the game
+        static float GetEffectCost(const RE::EffectSetting* baseEffect, float magnitude, std::uint32_t duration) {
+            return Settings::PotencyTable::GetEffectCost(baseEffect->data.baseCost, magnitude, duration);
+        }
+    };
+
+    // How the rename engine reads and names one kind of crafted item
+    template <class Item>
+    struct ItemTraits;
+
+    template <>
+    struct ItemTraits<RE::AlchemyItem> {
+        static constexpr auto KIND = Settings::SettingsLoader::ItemKind::Potion;
+
+        // Don't rename 1-effect potions
+        static constexpr int MIN_EFFECTS = 2;
+
+        // Potions that no rule matches are named from the name templates, if there are any
+        static constexpr bool GENERATIVE = true;
+
+        static std::span<RE::Effect* const> GetEffects(const RE::AlchemyItem* item) { return item->effects; }
+        static RE::Effect* GetCostliestEffect(RE::AlchemyItem* item) { return item->GetCostliestEffectItem(); }
+        static void SetName(RE::AlchemyItem* item, const RE::BSFixedString& name) { item->fullName = name; }
+    };
+
+    template <>
+    struct ItemTraits<RE::EnchantmentItem> {
+        static constexpr auto KIND = Settings::SettingsLoader::ItemKind::Enchantment;
+
+        // Most player-made enchantments have a single effect
+        static constexpr int MIN_EFFECTS = 1;
+
+        // An enchantment's name is chosen by the player when it is crafted, so only rules replace it
+        static constexpr bool GENERATIVE = false;
+
+        static std::span<RE::Effect* const> GetEffects(const RE::EnchantmentItem* item) { return item->effects; }
+        static RE::Effect* GetCostliestEffect(RE::EnchantmentItem* item) { return item->GetCostliestEffectItem(); }
+        static void SetName(RE::EnchantmentItem* item, const RE::BSFixedString& name) { item->fullName = name; }
+    };
+
+    // Matching and naming for one kind of crafted item. Everything that differs between kinds comes from its traits,
+    // so each kind's hook is compiled with only its own code.
+    template <class Item, class Traits = ItemTraits<Item>>
+    class RenameEngine {
+    public:
+        RenameEngine() = delete;
+
+        // Returns the rule for this item kind matching a set of effects, or nullptr if there is none
+        static const Settings::SettingsLoader::CustomPotion* FindRule(const Settings::SettingsLoader::RuleSet& rules,
+                                                                      std::span<RE::Effect* const> effects) {
+            using Settings::SettingsLoader;
+
+            const int effectCount = static_cast<int>(effects.size());
+            if (effectCount < Traits::MIN_EFFECTS || effectCount > SettingsLoader::MAX_EFFECTS) {
+                return nullptr;
+            }
+
+            RE::FormID effectIDs[SettingsLoader::MAX_EFFECTS] = {};
+            for (int i = 0; i < effectCount; i++) {
+                effectIDs[i] = effects[i]->baseEffect->GetFormID();
+            }
+            return rules.FindPotion({effectIDs, effectCount, Traits::KIND});
+        }
+
+        // Returns the potion generated for an item kind that no rule matches, or nullptr if none can be generated
+        static std::shared_ptr<const Settings::NameGenerator::GeneratedPotion> Generate(
+            const Settings::SettingsLoader::RuleSet& rules, std::span<RE::Effect* const> effects) {
+            if constexpr (Traits::GENERATIVE) {
+                if (rules.generator && static_cast<int>(effects.size()) >= Traits::MIN_EFFECTS) {
+                    return rules.generator->Generate(effects, rules);
+                }
+            }
+            return nullptr;
+        }
+
+        // Returns the name an item with these effects is given, or nothing if no rule matches and none can be
+        // generated. Only allocates the first time a name is generated.
+        static std::optional<RE::BSFixedString> GetName(const Settings::SettingsLoader::RuleSet& rules,
+                                                        std::span<RE::Effect* const> effects,
+                                                        const RE::Effect& costliestEffect) {
+            const auto rule = FindRule(rules, effects);
+            const auto generated = rule ? nullptr : Generate(rules, effects);
+            const auto potion = rule ? rule : generated ? &generated->potion : nullptr;
+            if (!potion) {
+                return std::nullopt;
+            }
+            // Copied, as a generated name may be evicted from the cache once it is no longer held
+            return potion->GetName(PotencyEstimator::EstimatePotency(effects, costliestEffect, rules));
+        }
+
+        static std::optional<RE::BSFixedString> GetName(const Settings::SettingsLoader::RuleSet& rules, Item* item) {
+            const auto costliestEffect = Traits::GetCostliestEffect(item);
+            if (!costliestEffect) {
+                return std::nullopt;
+            }
+            return GetName(rules, Traits::GetEffects(item), *costliestEffect);
+        }
+
+        // Gives an item the name its rules call for. Laps the stages of the rename on the timer, if given, which the
+        // craft hook uses to profile itself.
+        static RenameResult Rename(const Settings::SettingsLoader::RuleSet& rules, Item* item,
+                                   [[maybe_unused]] RenameTimer* timer = nullptr) {
+            const auto costliestEffect = Traits::GetCostliestEffect(item);
+            if (!costliestEffect) {
+                return {};
+            }
+            const auto effects = Traits::GetEffects(item);
+            const auto rule = FindRule(rules, effects);
+            const auto generated = rule ? nullptr : Generate(rules, effects);
+            if (timer) {
+                APR_PROFILE_LAP((*timer), Match);
+            }
+            if (rule) {
+                APR_TRACE("Found match with potion \"{}\"", rule->name);
+            } else if (generated) {
+                APR_TRACE("Generated name \"{}\"", generated->name);
+            } else {
+                return {};
+            }
+
+            const auto& potion = rule ? *rule : generated->potion;
+            const float potency = PotencyEstimator::EstimatePotency(effects, *costliestEffect, rules);
+            if (timer) {
+                APR_PROFILE_LAP((*timer), Potency);
+            }
+            const auto& name = potion.GetName(potency);
+            if (timer) {
+                APR_PROFILE_LAP((*timer), Format);
+            }
+            Traits::SetName(item, name);
+            if (timer) {
+                APR_PROFILE_LAP((*timer), Assign);
+            }
+            return {rule, true};
+        }
+    };
+
+    using PotionEngine = RenameEngine<RE::AlchemyItem>;
+    using EnchantmentEngine = RenameEngine<RE::EnchantmentItem>;
+}
@@ -0,0 +1,365 @@
+#include "RuleCache.h"
+
+#include "BuiltinRules.h"
+#include "logger.h"
+#include "NameGenerator.h"
+
+namespace Settings {
+    namespace {
+        // FNV-1a, 64-bit
+        class Hasher {
+        private:
+            std::uint64_t hash = 14695981039346656037ull;
+
+        public:
+            void Add(const void* data, std::size_t size) {
+                const auto bytes = static_cast<const std::uint8_t*>(data);
+                for (std::size_t i = 0; i < size; i++) {
+                    hash = (hash ^ bytes[i]) * 1099511628211ull;
+                }
+            }
+
+            void Add(std::string_view string) {
+                Add(string.data(), string.size());
+                // Separate consecutive strings so that "ab" + "c" and "a" + "bc" differ
+                Add<std::uint8_t>(0);
+            }
+
+            template <class T>
+                requires std::is_trivially_copyable_v<T>
+            void Add(const T& value) {
+                Add(&value, sizeof(T));
+            }
+
+            std::uint64_t Get() const { return hash; }
+        };
+
+        class Writer {
+        private:
+            std::vector<char>& buffer;
+
+        public:
+            explicit Writer(std::vector<char>& p_buffer) : buffer(p_buffer) {}
+
+            void WriteBytes(const void* data, std::size_t size) {
+                const auto bytes = static_cast<const char*>(data);
+                buffer.insert(buffer.end(), bytes, bytes + size);
+            }
+
+            template <class T>
+                requires std::is_trivially_copyable_v<T>
+            void Write(const T& value) {
+                WriteBytes(&value, sizeof(T));
+            }
+
+            void WriteString(std::string_view string) {
+                Write<std::uint32_t>(static_cast<std::uint32_t>(string.size()));
+                WriteBytes(string.data(), string.size());
+            }
+        };
+
+        class Reader {
+        private:
+            const char* position;
+            const char* end;
+
+        public:
+            Reader(const void* data, std::size_t size)
+                : position(static_cast<const char*>(data)), end(position + size) {}
+
+            void ReadBytes(void* data, std::size_t size) {
+                if (static_cast<std::size_t>(end - position) < size) {
+                    throw std::runtime_error("Unexpected end of cache file");
+                }
+                std::memcpy(data, position, size);
+                position += size;
+            }
+
+            template <class T>
+                requires std::is_trivially_copyable_v<T>
+            T Read() {
+                T value;
+                ReadBytes(&value, sizeof(T));
+                return value;
+            }
+
+            std::string ReadString() {
+                std::string string(Read<std::uint32_t>(), '\0');
+                ReadBytes(string.data(), string.size());
+                return string;
+            }
+        };
+
+        // Read-only view of a whole file
+        class MappedFile {
+        private:
+            HANDLE file = INVALID_HANDLE_VALUE;
+            HANDLE mapping = nullptr;
+            const void* view = nullptr;
+            std::size_t size = 0;
+
+        public:
+            explicit MappedFile(const std::filesystem::path& path) {
+                file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE) {
+                    return;
+                }
+                LARGE_INTEGER fileSize;
+                if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+                    return;
+                }
+                mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!mapping) {
+                    return;
+                }
+                view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view) {
+                    size = static_cast<std::size_t>(fileSize.QuadPart);
+                }
+            }
+
+            ~MappedFile() {
+                if (view) UnmapViewOfFile(view);
+                if (mapping) CloseHandle(mapping);
+                if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const void* GetData() const { return view; }
+            std::size_t GetSize() const { return size; }
+        };
+    }
+
+    std::uint64_t RuleCache::ComputeInputHash(const std::vector<std::filesystem::path>& jsonPaths) {
+        Hasher hasher;
+        hasher.Add(VERSION);
+#ifdef APR_BUILTIN_RULES
+        hasher.Add(BuiltinRules::PACK_HASH);
+#endif
+
+        for (const auto& jsonPath : jsonPaths) {
+            std::ifstream reader(jsonPath, std::ios::binary);
+            const std::string contents{std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>()};
+            hasher.Add(jsonPath.filename().string());
+            hasher.Add(contents);
+        }
+
+        // Runtime FormIDs depend on the load order, and effect data on the plugins' contents
+        const auto dataHandler = RE::TESDataHandler::GetSingleton();
+        if (dataHandler) {
+            const auto dataPath = std::filesystem::current_path() / "Data";
+            const auto addPlugins = [&](const auto& files) {
+                for (const auto file : files) {
+                    const auto fileName = file->GetFilename();
+                    hasher.Add(fileName);
+
+                    std::error_code error;
+                    const auto writeTime = std::filesystem::last_write_time(dataPath / fileName, error);
+                    hasher.Add(error ? 0ll : static_cast<long long>(writeTime.time_since_epoch().count()));
+                }
+            };
+            addPlugins(dataHandler->compiledFileCollection.files);
+            hasher.Add(std::string_view("light"));
+            addPlugins(dataHandler->compiledFileCollection.smallFiles);
+        }
+
+        return hasher.Get();
+    }
+
+    std::unique_ptr<SettingsLoader::RuleSet> RuleCache::Load(const std::filesystem::path& cachePath,
+                                                             std::uint64_t inputHash) {
+        const MappedFile cacheFile(cachePath);
+        if (!cacheFile.GetData()) {
+            logger::info("No rule cache found");
+            return nullptr;
+        }
+
+        try {
+            Reader reader(cacheFile.GetData(), cacheFile.GetSize());
+            if (reader.Read<std::uint32_t>() != MAGIC || reader.Read<std::uint32_t>() != VERSION) {
+                logger::info("Rule cache was written by a different version, ignoring it");
+                return nullptr;
+            }
+            if (reader.Read<std::uint64_t>() != inputHash) {
+                logger::info("JSON files or plugins have changed since the rule cache was written, ignoring it");
+                return nullptr;
+            }
+
+            auto rules = std::make_unique<SettingsLoader::RuleSet>();
+            rules->useRomanNumerals = reader.Read<std::uint8_t>() != 0;
+            rules->recordCrafts = reader.Read<std::uint8_t>() != 0;
+            rules->batchRenameBudget = reader.Read<float>();
+            rules->namePreview = reader.Read<std::uint8_t>() != 0;
+            rules->logLevel = static_cast<spdlog::level::level_enum>(reader.Read<std::uint8_t>());
+            if (rules->logLevel > spdlog::level::err) {
+                throw std::runtime_error("Invalid log level");
+            }
+            rules->potencies.aggregation = static_cast<Settings::PotencyAggregation>(reader.Read<std::uint8_t>());
+
+            const auto categoryCount = reader.Read<std::uint32_t>();
+            for (std::uint32_t i = 0; i < categoryCount; i++) {
+                std::vector<std::string> categoryDescriptors = {};
+                const auto descriptorCount = reader.Read<std::uint32_t>();
+                for (std::uint32_t j = 0; j < descriptorCount; j++) {
+                    categoryDescriptors.push_back(reader.ReadString());
+                }
+                rules->descriptors.push_back(rules->InternDescriptors(categoryDescriptors));
+            }
+
+            rules->builtinPotionBase = reader.Read<std::int32_t>();
+            const auto potionCount = reader.Read<std::uint32_t>();
+            for (std::uint32_t i = 0; i < potionCount; i++) {
+                const int effectCount = reader.Read<std::uint8_t>();
+                if (effectCount < 1 || effectCount > SettingsLoader::MAX_RULE_EFFECTS) {
+                    throw std::runtime_error("Invalid effect count");
+                }
+                RE::FormID effectIDs[SettingsLoader::MAX_RULE_EFFECTS] = {};
+                reader.ReadBytes(effectIDs, effectCount * sizeof(RE::FormID));
+                const auto format = static_cast<SettingsLoader::DescriptorFormat>(reader.Read<std::uint8_t>());
+                const auto descriptorIndex = reader.Read<std::int32_t>();
+                if (descriptorIndex < -1 || descriptorIndex >= (int)rules->descriptors.size()) {
+                    throw std::runtime_error("Invalid descriptor index");
+                }
+                const auto match = static_cast<SettingsLoader::MatchMode>(reader.Read<std::uint8_t>());
+                const auto priority = reader.Read<std::int32_t>();
+                const auto kind = static_cast<SettingsLoader::ItemKind>(reader.Read<std::uint8_t>());
+                if (kind >= SettingsLoader::ItemKind::Count) {
+                    throw std::runtime_error("Invalid item kind");
+                }
+                const auto name = rules->strings.Intern(reader.ReadString());
+                rules->potions.push_back(
+                    {effectIDs, name, format, effectCount, descriptorIndex, match, priority, kind});
+            }
+            if (rules->builtinPotionBase < -1 || rules->builtinPotionBase > (int)rules->potions.size()) {
+                throw std::runtime_error("Invalid built-in potion index");
+            }
+
+            // Potency records are stored exactly as they are laid out in memory
+            auto& potencies = rules->potencies;
+            potencies.records.resize(reader.Read<std::uint32_t>());
+            reader.ReadBytes(potencies.records.data(),
+                             potencies.records.size() * sizeof(SettingsLoader::PotencyRecord));
+            potencies.curveTables.resize(reader.Read<std::uint32_t>());
+            reader.ReadBytes(potencies.curveTables.data(), potencies.curveTables.size() * sizeof(float));
+            for (const auto& record : potencies.records) {
+                const int offset = record.curveOffset;
+                const int tableSize = static_cast<int>(potencies.curveTables.size());
+                if (offset != -1 && (offset < 0 || offset + SettingsLoader::CURVE_RESOLUTION > tableSize)) {
+                    throw std::runtime_error("Invalid curve offset");
+                }
+            }
+
+            if (reader.Read<std::uint8_t>() != 0) {
+                auto generator = std::make_shared<NameGenerator>();
+                generator->descriptorIndex = reader.Read<std::int32_t>();
+                if (generator->descriptorIndex < -1 || generator->descriptorIndex >= (int)rules->descriptors.size()) {
+                    throw std::runtime_error("Invalid descriptor index");
+                }
+                generator->capacity = std::max<std::size_t>(reader.Read<std::uint32_t>(), 1);
+                for (int i = 0; i <= SettingsLoader::MAX_EFFECTS; i++) {
+                    auto& nameTemplate = generator->templates[i];
+                    nameTemplate = reader.ReadString();
+                    if (!nameTemplate.empty() && (i < 2 || NameTemplate::Validate(nameTemplate, i))) {
+                        throw std::runtime_error("Invalid name template");
+                    }
+                }
+                const auto fragmentCount = reader.Read<std::uint32_t>();
+                for (std::uint32_t i = 0; i < fragmentCount; i++) {
+                    const auto effectID = reader.Read<RE::FormID>();
+                    auto noun = reader.ReadString();
+                    auto adjective = reader.ReadString();
+                    generator->fragments.try_emplace(effectID,
+                                                     NameGenerator::Fragment{std::move(noun), std::move(adjective)});
+                }
+                rules->generator = std::move(generator);
+            }
+
+            logger::info("Loaded {} potions and {} effect potencies from the rule cache", rules->potions.size(),
+                         rules->potencies.records.size());
+            return rules;
+        } catch (std::exception& e) {
+            logger::warn("Rule cache is corrupt, ignoring it: {}", e.what());
+            return nullptr;
+        }
+    }
+
+    void RuleCache::Save(const std::filesystem::path& cachePath, std::uint64_t inputHash,
+                         const SettingsLoader::RuleSet& rules) {
+        static_assert(std::is_trivially_copyable_v<SettingsLoader::PotencyRecord>);
+
+        std::vector<char> buffer;
+        Writer writer(buffer);
+        writer.Write(MAGIC);
+        writer.Write(VERSION);
+        writer.Write(inputHash);
+        writer.Write<std::uint8_t>(rules.useRomanNumerals);
+        writer.Write<std::uint8_t>(rules.recordCrafts);
+        writer.Write(rules.batchRenameBudget);
+        writer.Write<std::uint8_t>(rules.namePreview);
+        writer.Write<std::uint8_t>(rules.logLevel);
+        writer.Write<std::uint8_t>(static_cast<std::uint8_t>(rules.potencies.aggregation));
+
+        writer.Write<std::uint32_t>(rules.descriptors.size());
+        for (const auto& categoryDescriptors : rules.descriptors) {
+            writer.Write<std::uint32_t>(categoryDescriptors.size());
+            for (const auto& descriptor : categoryDescriptors) {
+                writer.WriteString(descriptor);
+            }
+        }
+
+        writer.Write<std::int32_t>(rules.builtinPotionBase);
+        writer.Write<std::uint32_t>(rules.potions.size());
+        for (const auto& potion : rules.potions) {
+            writer.Write<std::uint8_t>(static_cast<std::uint8_t>(potion.effectCount));
+            writer.WriteBytes(potion.effectIDs, potion.effectCount * sizeof(RE::FormID));
+            writer.Write<std::uint8_t>(static_cast<std::uint8_t>(potion.format));
+            writer.Write<std::int32_t>(potion.descriptorIndex);
+            writer.Write<std::uint8_t>(static_cast<std::uint8_t>(potion.match));
+            writer.Write<std::int32_t>(potion.priority);
+            writer.Write<std::uint8_t>(static_cast<std::uint8_t>(potion.kind));
+            writer.WriteString(potion.name);
+        }
+
+        const auto& potencies = rules.potencies;
+        writer.Write<std::uint32_t>(static_cast<std::uint32_t>(potencies.records.size()));
+        writer.WriteBytes(potencies.records.data(), potencies.records.size() * sizeof(SettingsLoader::PotencyRecord));
+        writer.Write<std::uint32_t>(static_cast<std::uint32_t>(potencies.curveTables.size()));
+        writer.WriteBytes(potencies.curveTables.data(), potencies.curveTables.size() * sizeof(float));
+
+        writer.Write<std::uint8_t>(rules.generator != nullptr);
+        if (const auto& generator = rules.generator) {
+            writer.Write<std::int32_t>(generator->descriptorIndex);
+            writer.Write<std::uint32_t>(static_cast<std::uint32_t>(generator->capacity));
+            for (const auto& nameTemplate : generator->templates) {
+                writer.WriteString(nameTemplate);
+            }
+            writer.Write<std::uint32_t>(static_cast<std::uint32_t>(generator->fragments.size()));
+            for (const auto& [effectID, fragment] : generator->fragments) {
+                writer.Write(effectID);
+                writer.WriteString(fragment.noun);
+                writer.WriteString(fragment.adjective);
+            }
+        }
+
+        // Write to a temporary file first so that a partly written cache is never picked up
+        auto tempPath = cachePath;
+        tempPath += ".tmp";
+        {
+            std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+            if (!output.write(buffer.data(), buffer.size())) {
+                logger::warn("Failed to write rule cache");
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error) {
+            logger::warn("Failed to write rule cache: {}", error.message());
+            return;
+        }
+        logger::info("Wrote {} bytes to the rule cache", buffer.size());
+    }
+}
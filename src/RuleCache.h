@@ -0,0 +1,26 @@
+#pragma once
+
+#include "SettingsLoader.h"
+
+namespace Settings {
+    // Stores fully resolved rule sets between launches, so unchanged JSON files do not need to be parsed again
+    class RuleCache {
+    private:
+        static constexpr std::uint32_t MAGIC = 0x43525041;  // "APRC"
+        static constexpr std::uint32_t VERSION = 10;
+
+    public:
+        RuleCache() = delete;
+
+        // Hashes every input that affects a rule set: the JSON files and the active plugins
+        static std::uint64_t ComputeInputHash(const std::vector<std::filesystem::path>& jsonPaths);
+
+        // Returns nullptr if there is no cache or it was built from different inputs.
+        // Potion names and the potion index are not stored and must be rebuilt.
+        static std::unique_ptr<SettingsLoader::RuleSet> Load(const std::filesystem::path& cachePath,
+                                                             std::uint64_t inputHash);
+
+        static void Save(const std::filesystem::path& cachePath, std::uint64_t inputHash,
+                         const SettingsLoader::RuleSet& rules);
+    };
+}
@@ -1,5 +1,16 @@
 #include "SettingsLoader.h"
+#include "AsyncLog.h"
+#include "BatchRenamer.h"
+#include "BuiltinRules.h"
+#include "EditorIDIndex.h"
+#include "FormResolver.h"
+#include "JsonReader.h"
 #include "logger.h"
+#include "NameFormat.h"
+#include "NameGenerator.h"
+#include "Profiler.h"
+#include "RuleCache.h"
+#include "RuleParser.h"
 #include "Utils.h"
 
 namespace Settings {
@@ -10,291 +21,542 @@ namespace Settings {
     }
 
     void SettingsLoader::LoadSettings() {
+        mainThreadID = std::this_thread::get_id();
+        PublishRules(BuildRules());
+    }
+
+    SettingsLoader::ReloadStatus SettingsLoader::ReloadSettings() {
+        if (!GetRules()) {
+            logger::warn("Rules cannot be reloaded before the game data has loaded");
+            return ReloadStatus::NotLoaded;
+        }
+        if (reloading.exchange(true)) {
+            logger::warn("Rules are already being reloaded");
+            return ReloadStatus::Busy;
+        }
+
+        // The new rule set is built away from the main thread, then swapped in once it is complete
+        std::thread([this]() {
+            logger::info("Reloading settings...");
+            try {
+                PublishRules(BuildRules());
+                Hooks::BatchRenamer::Start();
+            } catch (std::exception& e) {
+                logger::error("Failed to reload settings, keeping the current rules: {}", e.what());
+            }
+            reloading.store(false);
+        }).detach();
+        return ReloadStatus::Started;
+    }
+
+    void SettingsLoader::RunOnMainThread(const std::function<void()>& task) const {
+        if (std::this_thread::get_id() == mainThreadID) {
+            task();
+            return;
+        }
+
+        // Only reloads get here, and the main thread never waits for a reload, so this cannot deadlock
+        std::promise<void> done;
+        SKSE::GetTaskInterface()->AddTask([&task, &done]() {
+            try {
+                task();
+                done.set_value();
+            } catch (...) {
+                done.set_exception(std::current_exception());
+            }
+        });
+        done.get_future().get();
+    }
+
+    std::shared_ptr<const SettingsLoader::RuleSet> SettingsLoader::AcquireRules() const {
+        std::lock_guard lock(ownedRulesLock);
+        return ownedRules;
+    }
+
+    void SettingsLoader::PublishRules(std::shared_ptr<const RuleSet> rules) {
+        std::shared_ptr<const RuleSet> retiredRules;
+        {
+            std::lock_guard lock(ownedRulesLock);
+            retiredRules = std::exchange(ownedRules, rules);
+            currentRules.store(rules.get(), std::memory_order_release);
+        }
+
+        // Readers of GetRules() only run on the main thread, so the old rule set can be released once the main
+        // thread has reached its task queue. Copies handed out by AcquireRules() keep it alive beyond that.
+        if (retiredRules) {
+            SKSE::GetTaskInterface()->AddTask([retiredRules]() {});
+        }
+        spdlog::set_level(rules->logLevel);
+        logger::info("Published rule set with {} potions, using {} KiB in {} blocks ({} unique strings)",
+                     rules->potions.size(), rules->heap.GetAllocatedBytes() / 1024, rules->heap.GetBlockCount(),
+                     rules->strings.size());
+    }
+
+    std::unique_ptr<SettingsLoader::RuleSet> SettingsLoader::BuildRules() {
         std::filesystem::path jsonPath = std::filesystem::current_path();
         jsonPath += "\\Data\\SKSE\\Plugins\\AutoPotionRenamer";
+        const auto settingsPath = jsonPath / "UserSettings.json";
+        const auto cachePath = jsonPath / "RuleCache.bin";
+
+        std::vector<RuleFile> ruleFiles = {};
+        std::vector<std::filesystem::path> inputPaths = {settingsPath};
+        for (const auto& entry : std::filesystem::directory_iterator(jsonPath)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json" && entry.path().filename() != "UserSettings.json") {
+                ruleFiles.push_back({entry.path()});
+                inputPaths.push_back(entry.path());
+            }
+        }
+        std::sort(inputPaths.begin() + 1, inputPaths.end());
+
+        // Skip parsing and form lookups entirely when nothing has changed since the cache was written
+        const auto inputHash = RuleCache::ComputeInputHash(inputPaths);
+        [[maybe_unused]] const auto cacheStart = std::chrono::steady_clock::now();
+        if (auto rules = RuleCache::Load(cachePath, inputHash)) {
+            FinishRules(*rules);
+            APR_PROFILE_LOAD("RuleCache.bin", cacheStart);
+            return rules;
+        }
+
+        auto rules = std::make_unique<RuleSet>();
 
         // Temporary map to link descriptor names to their indices during loading
         std::map<std::string, int> descriptorNameMap = {};
         int lastIndex = 0;
-
-        ReadSettingsFile(jsonPath.string() + "\\UserSettings.json", descriptorNameMap, lastIndex);
-
-        for (const auto& entry : std::filesystem::directory_iterator(jsonPath)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".json" && entry.path().filename() != "UserSettings.json") {
-                ReadPotionFile(entry.path(), descriptorNameMap, lastIndex);
+        PotencyMap potencyMap = {};
+
+        [[maybe_unused]] const auto settingsStart = std::chrono::steady_clock::now();
+        ReadSettingsFile(*rules, settingsPath, descriptorNameMap, lastIndex);
+        APR_PROFILE_LOAD("UserSettings.json", settingsStart);
+
+        // Applied now as well as when the rules are published, so that the rest of the load is logged at this level
+        spdlog::set_level(rules->logLevel);
+
+        // Files do not depend on each other until they are merged, so they are read and parsed in parallel
+        std::for_each(std::execution::par, ruleFiles.begin(), ruleFiles.end(), [](RuleFile& ruleFile) {
+            [[maybe_unused]] const auto parseStart = std::chrono::steady_clock::now();
+            RuleParser::ParsePotionFile(ruleFile);
+            APR_PROFILE_LOAD(ruleFile.path.filename().string(), parseStart);
+        });
+
+        // directory_iterator order is unspecified, so merge in a defined order: highest priority, then by filename
+        std::sort(ruleFiles.begin(), ruleFiles.end(), [](const RuleFile& a, const RuleFile& b) {
+            return a.priority != b.priority ? a.priority > b.priority : a.path.filename() < b.path.filename();
+        });
+
+        // Rules share a handful of effects between them, so each distinct identifier is looked up only once.
+        // This goes through the data handler, so a reload hands it to the main thread and waits.
+        FormResolver forms;
+        RuleParser::AddIdentifiers(ruleFiles, forms);
+        RunOnMainThread([&forms]() { forms.Resolve(); });
+
+        for (const auto& ruleFile : ruleFiles) {
+            if (ruleFile.parsed) {
+                ReadPotionFile(*rules, potencyMap, ruleFile, forms, descriptorNameMap, lastIndex);
             }
         }
+        ReadGeneratorsIn(*rules, ruleFiles, forms, descriptorNameMap, lastIndex);
+
+#ifdef APR_BUILTIN_RULES
+        AddBuiltinRules(*rules, potencyMap, descriptorNameMap, lastIndex);
+#endif
 
         int categoryCount = 0;
         for (const auto& pair : descriptorNameMap) {
-            if (descriptors[pair.second].size() == 0) {
+            if (rules->descriptors[pair.second].size() == 0) {
                 logger::warn(
                     "Warning: Descriptors not found for category \"{}\", '{{}}' will be stripped from potion names",
                     pair.first);
             } else {
                 categoryCount++;
             }
-            logger::trace("\"{}\" is at index {}", pair.first, pair.second);
+            APR_TRACE("\"{}\" is at index {}", pair.first, pair.second);
         }
         logger::info("{} descriptor categories loaded", categoryCount);
+
+        FinishRules(*rules);
+        RunOnMainThread([&]() { BuildPotencyTable(*rules, potencyMap); });
+
+        RuleCache::Save(cachePath, inputHash, *rules);
+
+        return rules;
     }
 
-    void SettingsLoader::ReadPotionFile(const std::filesystem::path& jsonPath,
-                                        std::map<std::string, int>& descriptorNameMap,
-                                        int& descriptorIndex) {
-        try {
-            Json::Value root = GetJson(jsonPath);
+    void SettingsLoader::FinishRules(RuleSet& rules) {
+        CompileNames(rules);
+        BuildPotionIndex(rules);
+    }
 
-            // Read potion definitions
-            if (!root["potions"] || !root["potions"].isArray()) {
-                logger::error("Failed to read \"potions\" option");
-            } else if (root["potions"].size() > MAX_POTIONS) {
-                logger::error("Failed to read \"potions\" option - exceeded maximum");
-            } else {
-                ReadPotionsIn(root["potions"], descriptorNameMap, descriptorIndex);
+    void SettingsLoader::CompileNames(RuleSet& rules) {
+        const auto usesDescriptors = [&rules](const CustomPotion& potion) {
+            return !rules.useRomanNumerals && potion.descriptorIndex != -1 &&
+                   rules.descriptors[potion.descriptorIndex].size() != 0;
+        };
+
+        // Size the name table up front, so that the spans handed to each potion stay valid
+        std::size_t nameCount = 0;
+        for (const auto& potion : rules.potions) {
+            nameCount += rules.useRomanNumerals   ? std::size(NameFormat::ROMAN_NUMERALS)
+                         : usesDescriptors(potion) ? rules.descriptors[potion.descriptorIndex].size()
+                                                   : 1;
+        }
+        rules.names.clear();
+        rules.names.reserve(nameCount);
+
+        // Every name a potion can be given is rendered up front, so renaming only has to pick one
+        for (auto& potion : rules.potions) {
+            const auto first = rules.names.size();
+            for (const auto& name : RenderNames(rules, potion.name, potion.format, potion.descriptorIndex)) {
+                rules.names.push_back(RE::BSFixedString(name));
             }
+            potion.names = std::span(rules.names).subspan(first);
+        }
+    }
 
-            // Read effect potencies
-            if (!root["effectPotencies"]) {
-                logger::info("\"effectPotencies\" not found, will use default values");
-            } else if (root["effectPotencies"].size() > MAX_POTENCIES) {
-                logger::error("Failed to read \"effectPotencies\" option - exceeded maximum");
-            } else {
-                ReadPotenciesIn(root["effectPotencies"]);
+    std::vector<std::string> SettingsLoader::RenderNames(const RuleSet& rules, std::string_view name,
+                                                         DescriptorFormat format, int descriptorIndex) {
+        std::vector<std::string> names;
+
+        // Numerals and descriptors are placed in different positions
+        if (rules.useRomanNumerals) {
+            const std::string baseName = NameFormat::FormatName(name, format, "");
+            for (const auto numeral : NameFormat::ROMAN_NUMERALS) {
+                names.push_back(baseName + " " + numeral);
+            }
+        } else if (descriptorIndex == -1 || rules.descriptors[descriptorIndex].size() == 0) {
+            names.push_back(NameFormat::FormatName(name, format, ""));
+        } else {
+            for (const auto descriptor : rules.descriptors[descriptorIndex]) {
+                names.push_back(NameFormat::FormatName(name, format, descriptor));
             }
+        }
+        return names;
+    }
 
-            // Read descriptor definitions
-            if (root["descriptors"]) {
-                if (root["descriptors"].size() > MAX_DESCRIPTORS) {
-                    logger::error("Failed to read \"descriptors\" option - exceeded maximum");
-                } else {
-                    ReadDescriptorsIn(root["descriptors"], descriptorNameMap, descriptorIndex);
+    void SettingsLoader::BuildPotionIndex(RuleSet& rules) {
+        const auto& potions = rules.potions;
+        const int fileCount = rules.builtinPotionBase == -1 ? (int)potions.size() : rules.builtinPotionBase;
+        for (const auto& potion : potions) {
+            rules.kindCounts[static_cast<std::size_t>(potion.kind)]++;
+        }
+        rules.matcher.Build(std::span<const CustomPotion>(potions.data(), fileCount));
+
+#ifdef APR_PROFILING
+        rules.potionHits = std::make_unique<std::atomic<std::uint64_t>[]>(potions.size());
+#endif
+    }
+
+    void SettingsLoader::BuildPotencyTable(RuleSet& rules, const PotencyMap& potencyMap) {
+        const auto dataHandler = RE::TESDataHandler::GetSingleton();
+        if (!dataHandler) {
+            logger::error("Data handler not found, effect potencies will use default values");
+            return;
+        }
+
+        // Resolve every entry to the magic effects it names, preferring editor IDs over names
+        for (const auto effect : dataHandler->GetFormArray<RE::EffectSetting>()) {
+            if (!effect) {
+                continue;
+            }
+            auto entry = potencyMap.find(EditorIDIndex::GetEditorID(effect->GetFormID()));
+            if (entry == potencyMap.end()) {
+                entry = potencyMap.find(std::string_view(effect->GetName()));
+            }
+            if (entry != potencyMap.end()) {
+                rules.potencies.Add(effect->GetFormID(), entry->second, GetPotencyDriver(effect));
+            }
+        }
+        rules.potencies.Sort();
+        logger::info("Resolved {} effect potencies to {} magic effects", potencyMap.size(),
+                     rules.potencies.records.size());
+
+        // Warned about here, once per effect, rather than every time a potion with the effect is crafted
+        std::set<const RE::EffectSetting*> missing;
+        for (const auto ingredient : dataHandler->GetFormArray<RE::IngredientItem>()) {
+            if (!ingredient) {
+                continue;
+            }
+            for (const auto effect : ingredient->effects) {
+                if (effect && effect->baseEffect && !rules.potencies.Find(effect->baseEffect->GetFormID())) {
+                    missing.insert(effect->baseEffect);
                 }
             }
+        }
+        for (const auto effect : missing) {
+            logger::warn("Did not find potency entry for {} [{}], it will use the default range", effect->GetName(),
+                         Utils::GetHexString(effect->GetFormID()));
+        }
+    }
 
-        } catch (std::exception& e) {
-            logger::error("Encountered an error while parsing file {}: {}", jsonPath.filename().string(), e.what());
+    SettingsLoader::PotencyDriver SettingsLoader::GetPotencyDriver(const RE::EffectSetting* effect) {
+        using EffectFlag = RE::EffectSetting::EffectSettingData::Flag;
+
+        if (effect->data.flags & EffectFlag::kPowerAffectsMagnitude) {
+            return PotencyDriver::Magnitude;
+        } else if (effect->data.flags & EffectFlag::kPowerAffectsDuration) {
+            return PotencyDriver::Duration;
+        } else {  // Neither magnitude nor duration are affected - hopefully this is not possible
+            return PotencyDriver::None;
         }
     }
 
-    void SettingsLoader::ReadSettingsFile(const std::filesystem::path& jsonPath,
+    SettingsLoader::DescriptorCategory SettingsLoader::RuleSet::InternDescriptors(
+        std::span<const std::string> categoryDescriptors) {
+        DescriptorCategory interned(&arena);
+        interned.reserve(categoryDescriptors.size());
+        for (const auto& descriptor : categoryDescriptors) {
+            interned.push_back(strings.Intern(descriptor));
+        }
+        return interned;
+    }
+
+    const SettingsLoader::CustomPotion* SettingsLoader::RuleSet::FindPotion(const EffectSignature& signature) const {
+        const auto potion = FindFilePotion(signature);
+#ifdef APR_BUILTIN_RULES
+        if (!potion && builtinPotionBase != -1) {
+            if (const int index = BuiltinRules::FindPotion(signature); index != -1) {
+                return &potions[builtinPotionBase + index];
+            }
+        }
+#endif
+        return potion;
+    }
+
+    const SettingsLoader::CustomPotion* SettingsLoader::RuleSet::FindFilePotion(
+        const EffectSignature& signature) const {
+        const int index = matcher.Find(signature);
+        return index != -1 ? &potions[index] : nullptr;
+    }
+
+    void SettingsLoader::ReadPotionFile(RuleSet& rules, PotencyMap& potencyMap, const RuleFile& ruleFile,
+                                        const FormSource& forms, std::map<std::string, int>& descriptorNameMap,
+                                        int& descriptorIndex) {
+        logger::info("Loading {} ...", ruleFile.path.filename().string());
+
+        ReadPotionsIn(rules, ruleFile.potions, forms, descriptorNameMap, descriptorIndex);
+
+        // Files are read from the highest priority down, so the first definition of a potency wins, as for potions
+        for (const auto& [potencyName, potency] : ruleFile.potencies) {
+            potencyMap.try_emplace(potencyName, potency);
+        }
+
+        ReadDescriptorsIn(rules, ruleFile.descriptors, descriptorNameMap, descriptorIndex);
+    }
+
+    void SettingsLoader::ReadSettingsFile(RuleSet& rules, const std::filesystem::path& jsonPath,
                                           std::map<std::string, int>& descriptorNameMap,
                                           int& descriptorIndex) {
+        const auto fileName = jsonPath.filename().string();
+        logger::info("Reading {} ...", fileName);
+
+        std::ifstream stream(jsonPath, std::ios::binary);
+        if (!stream.is_open()) {
+            logger::error("Failed to open {}", fileName);
+            return;
+        }
+
         try {
-            Json::Value settingsRoot = GetJson(jsonPath);
+            JsonReader reader(stream, fileName);
+            bool foundRomanNumerals = false;
+            bool foundDescriptors = false;
+            DescriptorDefinitions descriptorDefinitions = {};
+
+            std::string key;
+            reader.BeginObject();
+            while (reader.NextMember(key)) {
+                if (key == "useRomanNumerals" && reader.PeekType() == JsonReader::Type::Bool) {
+                    rules.useRomanNumerals = reader.ReadBool();
+                    foundRomanNumerals = true;
+                    logger::info("Read useRomanNumerals={}", rules.useRomanNumerals ? "True" : "False");
+                } else if (key == "recordCrafts" && reader.PeekType() == JsonReader::Type::Bool) {
+                    rules.recordCrafts = reader.ReadBool();
+                    logger::info("Read recordCrafts={}", rules.recordCrafts ? "True" : "False");
+                } else if (key == "namePreview" && reader.PeekType() == JsonReader::Type::Bool) {
+                    rules.namePreview = reader.ReadBool();
+                    logger::info("Read namePreview={}", rules.namePreview ? "True" : "False");
+                } else if (key == "potencyAggregation" && reader.PeekType() == JsonReader::Type::String) {
+                    const auto aggregation = reader.ReadString();
+                    if (aggregation == "costliest") {
+                        rules.potencies.aggregation = PotencyAggregation::Costliest;
+                    } else if (aggregation == "max") {
+                        rules.potencies.aggregation = PotencyAggregation::Max;
+                    } else if (aggregation == "mean") {
+                        rules.potencies.aggregation = PotencyAggregation::WeightedMean;
+                    } else {
+                        logger::error("Unknown potencyAggregation \"{}\" - expected \"costliest\", \"max\" or \"mean\"",
+                                      aggregation);
+                    }
+                    logger::info("Read potencyAggregation={}", aggregation);
+                } else if (key == "batchRenameBudget" && reader.PeekType() == JsonReader::Type::Number) {
+                    rules.batchRenameBudget = std::max(0.0f, static_cast<float>(reader.ReadNumber()));
+                    logger::info("Read batchRenameBudget={}", rules.batchRenameBudget);
+                } else if (key == "logLevel" && reader.PeekType() == JsonReader::Type::String) {
+                    const auto level = reader.ReadString();
+                    const auto parsedLevel = spdlog::level::from_str(level);
+                    if (parsedLevel <= spdlog::level::err) {
+                        rules.logLevel = parsedLevel;
+                    } else {
+                        logger::error("Unknown logLevel \"{}\" - expected \"trace\", \"debug\", \"info\", \"warn\" "
+                                      "or \"error\"",
+                                      level);
+                    }
+                    logger::info("Read logLevel={}", level);
+                } else if (key == "descriptors") {
+                    RuleParser::ParseDescriptors(reader, descriptorDefinitions);
+                    foundDescriptors = true;
+                } else {
+                    reader.Skip();
+                }
+            }
+            reader.ExpectEnd();
 
-            if (settingsRoot["useRomanNumerals"] && settingsRoot["useRomanNumerals"].isBool()) {
-                useRomanNumerals = settingsRoot["useRomanNumerals"].asBool();
-                logger::info("Read useRomanNumerals={}", useRomanNumerals ? "True" : "False");
-            } else {
+            if (!foundRomanNumerals) {
                 logger::error("Failed to read useRomanNumerals option");
             }
-
-            if (settingsRoot["descriptors"]) {
-                ReadDescriptorsIn(settingsRoot["descriptors"], descriptorNameMap, descriptorIndex);
+            if (foundDescriptors) {
+                ReadDescriptorsIn(rules, descriptorDefinitions, descriptorNameMap, descriptorIndex);
             } else {
                 logger::warn("Descriptor definitions not found in UserSettings.json");
             }
-        } catch (std::exception& e) {
-            logger::error("Encountered an error while parsing file {}: {}", jsonPath.filename().string(), e.what());
+        } catch (JsonReader::ParseError& e) {
+            logger::error("Json error: {}", e.what());
         }
     }
 
-    void SettingsLoader::ReadPotionsIn(const Json::Value& potionsRoot, std::map<std::string, int>& descriptorNameMap,
+    void SettingsLoader::ReadPotionsIn(RuleSet& rules, const std::vector<PotionDefinition>& potionDefinitions,
+                                       const FormSource& forms, std::map<std::string, int>& descriptorNameMap,
                                        int& descriptorIndex) {
-        for (const auto& potion : potionsRoot) {
-            DescriptorFormat format;
-            std::string name = "ERRORNAME";
-            int parsedIDs[MAX_EFFECTS] = {};
-            int effectCount = 0;
-
-            // Read name
-            if (potion["name"].isString()) {
-                name = potion["name"].asString();
-                int open = std::count(name.begin(), name.end(), '{');
-                int close = std::count(name.begin(), name.end(), '}');
-                if (open != close || open > 1 || (open > 0 && name.at(name.find('{') + 1) != '}')) {
-                    // Check for names that cannot be formatted correctly (and would cause a crash if used)
-                    logger::error(
-                        "Could not read potion name - name must contain 1 or fewer '{{}}' and no unbalanced braces");
-                    continue;
-                }
-
-                // Precalculate descriptor formatting
-                if (name.starts_with('{')) {
-                    format = After;
-                } else if (name.ends_with('}')) {
-                    format = Before;
-                } else {
-                    format = Both;
-                }
-            } else {
-                logger::error("Could not read potion name");
+        for (const auto& potion : potionDefinitions) {
+            const auto& name = potion.name;
+            RE::FormID parsedIDs[MAX_RULE_EFFECTS] = {};
+            const int effectCount = static_cast<int>(potion.effects.size());
+            if (!RuleParser::ResolveEffects(potion, forms, parsedIDs)) {
                 continue;
             }
 
-            // Read effects
-            const auto& effectFormIDs = potion["effects"];
-            if (effectFormIDs.isArray()) {
-                effectCount = effectFormIDs.size();
-                if (effectCount > MAX_EFFECTS || effectCount < 2) {
-                    logger::error(
-                        "Error loading effects - each potion must have between 2 and {} effects, skipping \"{}\"...",
-                        MAX_EFFECTS, name);
-                    continue;
-                }
-                bool problemLoadingEffects = false;
-                for (int i = 0; i < effectCount; i++) {
-                    RE::TESForm* form = nullptr;
-                    const std::string id = effectFormIDs[i].asString();
-                    // Load FormIDs in the form "Plugin.esp|BEEF0" or editor IDs in the form "AlchResistFrost"
-                    switch (std::count(id.begin(), id.end(), '|')) {
-                        case 0:  // Probably an editor ID
-                            form = RE::TESForm::LookupByEditorID(id);
-                            break;
-                        case 1:  // Probably a form ID
-                            form = GetFormFromIdentifier(id);
-                            break;
-                        default:  // Probably an error (caught by following 'if')
-                            break;
-                    }
-                    if (!form) {
-                        logger::error("Failed to load ID \"{}\", skipping \"{}\"...", effectFormIDs[i].asString(), name);
-                        problemLoadingEffects = true;
-                        break;
-                    } else if (!form->Is(RE::FormType::MagicEffect)) {
-                        logger::error(
-                            "Form {} was loaded as \"{}\", which is not an alchemy effect, skipping \"{}\"...",
-                            Utils::GetHexString(form->formID), Utils::GetFormEditorID(form), name);
-                        problemLoadingEffects = true;
-                        break;
-                    } else {
-                        parsedIDs[i] = form->formID;
-                    }
-                }
+            const int potionDescriptorIndex =
+                GetDescriptorIndex(rules, potion.descriptor, descriptorNameMap, descriptorIndex);
 
-                if (problemLoadingEffects) {
-                    continue;
-                }            
-            } else {
-                logger::error("Could not read \"{}\" effects", name);
-                continue;
-            }
+            CustomPotion customPotion = {parsedIDs, rules.strings.Intern(name), potion.format, effectCount,
+                                         potionDescriptorIndex, potion.match, potion.priority, potion.kind};
+            rules.potions.push_back(customPotion);
 
-            // Read descriptors
-            int potionDescriptorIndex = -1;
-            if (potion["descriptor"]) {
-                const std::string descriptorName = potion["descriptor"].asString();
-                if (descriptorNameMap.contains(descriptorName)) {
-                    // Look up the descriptor index
-                    potionDescriptorIndex = descriptorNameMap[descriptorName];
-                } else {  // We have found a potion defined before the descriptor it is referencing
-                    descriptors.push_back({});
-                    potionDescriptorIndex = descriptorIndex;
-                    descriptorNameMap[potion["descriptor"].asString()] = descriptorIndex++;
-                }
-            } else {
-                logger::warn("\"{}\" was missing \"descriptor\" field, '{{}}' will be removed.", name);
+            APR_DEBUG("\"{}\" has been read with {} effects", customPotion.name, effectCount);
+            for (int i = 0; i < effectCount; i++) {
+                APR_TRACE("    effect formID {:08X}", customPotion.effectIDs[i]);
             }
+        }
 
-            CustomPotion customPotion = {parsedIDs, name, format, effectCount, potionDescriptorIndex};
-            potions.push_back(customPotion);
+        logger::info("Successfully loaded {} potions", rules.potions.size());
+    }
 
-            std::string infoFormIDString = "";
-            for (auto id : customPotion.effectIDs) infoFormIDString += id == 0 ? "" : (Utils::GetHexString(id) + ", ");
-            logger::info("\"{}\" has been read with effect formIDs: {}", customPotion.name, infoFormIDString);
+    int SettingsLoader::GetDescriptorIndex(RuleSet& rules, const std::string& descriptor,
+                                           std::map<std::string, int>& descriptorNameMap, int& descriptorIndex) {
+        if (descriptor.empty()) {
+            return -1;
+        }
+        if (const auto it = descriptorNameMap.find(descriptor); it != descriptorNameMap.end()) {
+            return it->second;
         }
 
-        logger::info("Successfully loaded {} potions", potions.size());
+        // We have found a potion defined before the descriptor it is referencing
+        rules.descriptors.emplace_back();
+        descriptorNameMap[descriptor] = descriptorIndex;
+        return descriptorIndex++;
     }
 
-    // Source: https://github.com/Exit-9B/AlchemyPlus/blob/main/src/Settings/UserSettings.cpp
-    RE::TESForm* SettingsLoader::GetFormFromIdentifier(const std::string& a_identifier) {
-        std::istringstream ss{a_identifier};
-        std::string plugin, id;
-
-        std::getline(ss, plugin, '|');
-        std::getline(ss, id);
-        RE::FormID rawFormID;
-        std::istringstream(id) >> std::hex >> rawFormID;
+#ifdef APR_BUILTIN_RULES
+    void SettingsLoader::AddBuiltinRules(RuleSet& rules, PotencyMap& potencyMap,
+                                         std::map<std::string, int>& descriptorNameMap, int& descriptorIndex) {
+        // Descriptors and potencies from the pack only fill in what the JSON files left out
+        DescriptorDefinitions descriptorDefinitions = {};
+        for (const auto& category : BuiltinRules::descriptorCategories) {
+            std::vector<std::string> categoryDescriptors = {};
+            for (int i = 0; i < category.count; i++) {
+                categoryDescriptors.push_back(std::string(BuiltinRules::descriptors[category.first + i]));
+            }
+            descriptorDefinitions.emplace_back(std::string(category.name), std::move(categoryDescriptors));
+        }
+        ReadDescriptorsIn(rules, descriptorDefinitions, descriptorNameMap, descriptorIndex);
 
-        const auto dataHandler = RE::TESDataHandler::GetSingleton();
-        if (!dataHandler) {
-            logger::error("Data handler not found");
+        for (const auto& potency : BuiltinRules::potencies) {
+            potencyMap.try_emplace(std::string(potency.name),
+                                   PotencyDefinition{potency.min, potency.max, potency.curve, potency.exponent});
         }
-        return dataHandler->LookupForm(rawFormID, plugin);
-    }
 
-    void SettingsLoader::ReadPotenciesIn(const Json::Value& effectsRoot) {
-        // Duplicate entries are overwritten
-        for (const auto& potencyName : effectsRoot.getMemberNames()) {
-            const auto& potency = effectsRoot[potencyName];
-            if (potency.isMember("min") && potency.isMember("max")) {
-                if (potency["min"].isNumeric() && potency["max"].isNumeric()) {
-                    std::map<std::string, float> innerMap = {};
-                    innerMap["min"] = potency["min"].asFloat();
-                    innerMap["max"] = potency["max"].asFloat();
-                    potencies[potencyName] = innerMap;
-                    logger::info("Loaded \"{}\" with min potency {} and max potency {}", potencyName, innerMap["min"],
-                                 innerMap["max"]);
-                } else {
-                    logger::warn("\"{}\" did not have numeric min/max values, skipping", potencyName);
-                    continue;
-                }
-            } else {
-                logger::warn("{} did not have {} field, ignoring", potencyName,
-                             effectsRoot[potencyName].isMember("min") ? "max" : "min");
-                continue;
-            }
+        // Pack potions are matched through their own perfect hash, after every potion from the JSON files
+        rules.builtinPotionBase = static_cast<int>(rules.potions.size());
+        for (const auto& potion : BuiltinRules::potions) {
+            const int potionDescriptorIndex =
+                GetDescriptorIndex(rules, std::string(potion.descriptor), descriptorNameMap, descriptorIndex);
+            rules.potions.push_back(
+                {potion.effectIDs, potion.name, potion.format, potion.effectCount, potionDescriptorIndex});
         }
+        logger::info("Added {} potions from the built-in rule pack", BuiltinRules::potions.size());
     }
+#endif
 
-    void SettingsLoader::ReadDescriptorsIn(const Json::Value& descriptorsRoot,
-        std::map<std::string, int>& descriptorNameMap, int& descriptorIndex) {
-        logger::trace("Reading descriptors...");
-        for (const auto& categoryName : descriptorsRoot.getMemberNames()) {
-            RE::BSTArray<std::string> categoryDescriptors = {};
-            for (const auto& descriptor : descriptorsRoot[categoryName]) {
-                categoryDescriptors.push_back(descriptor.asString());
-            }
+    void SettingsLoader::ReadDescriptorsIn(RuleSet& rules, const DescriptorDefinitions& descriptorDefinitions,
+                                           std::map<std::string, int>& descriptorNameMap, int& descriptorIndex) {
+        for (const auto& [categoryName, categoryDescriptors] : descriptorDefinitions) {
             if (!descriptorNameMap.contains(categoryName)) {
                 // Add new descriptor category
-                descriptors.push_back(categoryDescriptors);
+                rules.descriptors.push_back(rules.InternDescriptors(categoryDescriptors));
                 descriptorNameMap[categoryName] = descriptorIndex++;
                 logger::info("Read descriptor category \"{}\"", categoryName);
-            } else if (descriptors[descriptorNameMap[categoryName]].size() == 0) { 
+            } else if (rules.descriptors[descriptorNameMap[categoryName]].size() == 0) { 
                 // Descriptor category name has been inferred from potion defintion
-                descriptors[descriptorNameMap[categoryName]] = categoryDescriptors;
+                rules.descriptors[descriptorNameMap[categoryName]] = rules.InternDescriptors(categoryDescriptors);
                 logger::info("Filled descriptor category \"{}\"", categoryName);
             } else {  
                 // Otherwise, do nothing so that the first definition loaded (from UserSettings.json) takes priority
                 logger::info("Ignoring duplicate definition for \"{}\" category", categoryName);
                 continue;
             }
-            
         }
     }
 
-    Json::Value SettingsLoader::GetJson(const std::filesystem::path& jsonPath) {
-        logger::info("Reading {} ...", jsonPath.filename().string());
-        std::ifstream reader;
-        reader.open(jsonPath);
-
-        if (!reader.is_open()) {
-            logger::error("Failed to open {}", jsonPath.filename().string());
-            throw std::runtime_error("Failed to open file");
+    void SettingsLoader::ReadGeneratorsIn(RuleSet& rules, const std::vector<RuleFile>& ruleFiles,
+                                          const FormSource& forms, std::map<std::string, int>& descriptorNameMap,
+                                          int& descriptorIndex) {
+        auto generator = std::make_shared<NameGenerator>();
+        std::string descriptor;
+        int cacheSize = 0;
+        bool hasTemplates = false;
+        for (const auto& ruleFile : ruleFiles) {
+            if (!ruleFile.parsed) {
+                continue;
+            }
+            const auto& definition = ruleFile.generator;
+            if (descriptor.empty()) {
+                descriptor = definition.descriptor;
+            }
+            if (cacheSize == 0) {
+                cacheSize = definition.cacheSize;
+            }
+            for (int i = 0; i <= MAX_EFFECTS; i++) {
+                if (generator->templates[i].empty() && !definition.templates[i].empty()) {
+                    generator->templates[i] = definition.templates[i];
+                    hasTemplates = true;
+                }
+            }
+            for (const auto& fragment : definition.fragments) {
+                const auto effectID = forms.FindEffect(fragment.effect);
+                if (!effectID) {
+                    logger::error("{}: {}, skipping the name fragments for it", definition.location, effectID.error());
+                    continue;
+                }
+                generator->fragments.try_emplace(*effectID, NameGenerator::Fragment{fragment.noun, fragment.adjective});
+            }
         }
 
-        Json::Value root;
-        Json::CharReaderBuilder builder;
-        std::string errs;
-
-        if (!Json::parseFromStream(builder, reader, &root, &errs)) {
-            logger::error("Json error: {}", errs);
-            throw std::runtime_error(errs);
+        if (!hasTemplates) {
+            return;
         }
-
-        reader.close();
-        return root;
+        generator->descriptorIndex = GetDescriptorIndex(rules, descriptor, descriptorNameMap, descriptorIndex);
+        if (cacheSize > 0) {
+            generator->capacity = static_cast<std::size_t>(cacheSize);
+        }
+        rules.generator = std::move(generator);
+        logger::info("Loaded name templates with fragments for {} effects", rules.generator->fragments.size());
     }
-}
\ No newline at end of file
+}
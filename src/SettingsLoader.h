@@ -1,74 +1,225 @@
 #pragma once
 
-namespace Settings {
-	class SettingsLoader {
-    private:
-        static const char MAX_POTIONS = 31;
-        static const char MAX_POTENCIES = 31;
-        static const char MAX_DESCRIPTORS = 15;
-        static const int MAX_EFFECTS = 4;
-
-        void ReadPotionsIn(const Json::Value& potionsRoot, std::map<std::string, int>& descriptorNameMap,
-                           int& descriptorIndex);
-
-        void ReadPotenciesIn(const Json::Value& effectsRoot);
-
-        void ReadDescriptorsIn(const Json::Value& descriptorsRoot, std::map<std::string, int>& descriptorNameMap,
-                               int& descriptorIndex);
-
-        Json::Value GetJson(const std::filesystem::path& jsonPath);
+#include "PotencyTable.h"
+#include "RuleArena.h"
+#include "RuleMatcher.h"
+#include "RuleTypes.h"
 
-        // Source: https://github.com/Exit-9B/AlchemyPlus/blob/main/src/Settings/UserSettings.cpp
-        RE::TESForm* GetFormFromIdentifier(const std::string& a_identifier);
-
-    public: 
-        enum DescriptorFormat {
-            Before,
-            After,
-            Both
-        };
+namespace Settings {
+    class FormSource;
+    class NameGenerator;
 
-        struct CustomPotion {
-            int effectIDs[MAX_EFFECTS] = {};
-            std::string name;
+	class SettingsLoader {
+    public:
+        // The rule model lives in RuleTypes.h, which does not depend on the game
+        static const int MAX_EFFECTS = Settings::MAX_EFFECTS;
+        static const int MAX_RULE_EFFECTS = Settings::MAX_RULE_EFFECTS;
+
+        using DescriptorFormat = Settings::DescriptorFormat;
+        using enum Settings::DescriptorFormat;
+        using MatchMode = Settings::MatchMode;
+        using ItemKind = Settings::ItemKind;
+        using EffectSignature = Settings::EffectSignature;
+        using EffectSignatureHash = Settings::EffectSignatureHash;
+        using PotencyCurve = Settings::PotencyCurve;
+        using PotencyDefinition = Settings::PotencyDefinition;
+        using PotencyMap = Settings::PotencyMap;
+
+        using Rule = Settings::Rule;
+        using PotencyAggregation = Settings::PotencyAggregation;
+        using PotencyDriver = Settings::PotencyDriver;
+        using PotencyRecord = Settings::PotencyRecord;
+
+        // Entries in the lookup table that each non-linear curve is baked into
+        static const int CURVE_RESOLUTION = PotencyTable::CURVE_RESOLUTION;
+
+        // A rule, with how the potions it matches are named
+        struct CustomPotion : Rule {
             DescriptorFormat format = Both;
-            int effectCount = 0;
             int descriptorIndex = -1;
 
+            // Every name this potion can be given, from least to most potent. Points into RuleSet::names.
+            std::span<const RE::BSFixedString> names = {};
+
             CustomPotion() = default;
 
-            CustomPotion(int effectIDs[MAX_EFFECTS], std::string_view p_name, DescriptorFormat p_format, int p_effectCount, int p_descriptorIndex = -1)
-                : name(p_name), format(p_format), effectCount(p_effectCount), descriptorIndex(p_descriptorIndex) {
+            CustomPotion(const RE::FormID effectIDs[], std::string_view p_name, DescriptorFormat p_format,
+                         int p_effectCount, int p_descriptorIndex = -1, MatchMode p_match = MatchMode::Exactly,
+                         int p_priority = 0, ItemKind p_kind = ItemKind::Potion)
+                : Rule{.name = p_name,
+                       .effectCount = p_effectCount,
+                       .match = p_match,
+                       .priority = p_priority,
+                       .kind = p_kind},
+                  format(p_format),
+                  descriptorIndex(p_descriptorIndex) {
                 for (int i = 0; i < effectCount; i++) {
                     this->effectIDs[i] = effectIDs[i];
                 }
             };
+
+            // Index into names of the name given at a potency, which must be between 0 and 1
+            int GetTier(float potency) const { return (int)(potency * (names.size() - 1)); }
+
+            // Potency must be between 0 and 1
+            const RE::BSFixedString& GetName(float potency) const { return names[GetTier(potency)]; }
+        };
+
+        using PotionArray = std::pmr::vector<CustomPotion>;
+
+        // Interned descriptors of one category, from least to most potent
+        using DescriptorCategory = std::pmr::vector<std::string_view>;
+
+        using DescriptorMap = std::pmr::vector<DescriptorCategory>;
+
+        // Everything read from the JSON files. A rule set is never modified once it has been published.
+        // All of its containers and strings are allocated from its arena, and freed together with it.
+        struct RuleSet {
+            CountingResource heap;
+            std::pmr::monotonic_buffer_resource arena{64 * 1024, &heap};
+
+            StringPool strings{&arena};
+
+            PotionArray potions{&arena};
+
+            // Pre-rendered names of every potion, each potion holding a span of its own
+            std::pmr::vector<RE::BSFixedString> names{&arena};
+
+            // Matches the potions from the JSON files, by their index in potions
+            RuleMatcher matcher{&arena};
+
+            PotencyTable potencies{&arena};
+
+            DescriptorMap descriptors{&arena};
+
+            bool useRomanNumerals = false;
+
+            // Append every crafted potion to a trace that can be replayed with "apr replay"
+            bool recordCrafts = false;
+
+            // Milliseconds per frame spent renaming potions crafted under older rules; 0 turns this off
+            float batchRenameBudget = 2.0f;
+
+            // Show the name a potion will get while choosing ingredients in the alchemy menu
+            bool namePreview = true;
+
+            // Applied to the log when the rules are published
+            spdlog::level::level_enum logLevel = spdlog::level::info;
+
+#ifdef APR_PROFILING
+            // Crafts renamed by each potion, counted by the profiler
+            mutable std::unique_ptr<std::atomic<std::uint64_t>[]> potionHits = {};
+#endif
+
+            // Index of the first potion from the built-in rule pack, or -1 if it is not included. Pack potions come
+            // after every potion from the JSON files, and are not in the matcher.
+            int builtinPotionBase = -1;
+
+            // Number of potions of each item kind, so that a kind without rules can skip renaming entirely
+            std::array<int, static_cast<std::size_t>(ItemKind::Count)> kindCounts = {};
+
+            // Names potions that no rule matches, or nullptr if no name templates are defined
+            std::shared_ptr<const NameGenerator> generator = {};
+
+            bool HasRules(ItemKind kind) const { return kindCounts[static_cast<std::size_t>(kind)] > 0; }
+
+            // Returns the potion to use for the given effects, or nullptr if there is none. Potions from the JSON
+            // files are preferred over those from the built-in rule pack.
+            const CustomPotion* FindPotion(const EffectSignature& signature) const;
+
+            // Returns the highest priority potion from the JSON files matching the given effects, or nullptr if
+            // there is none. Ties go to "exactly" rules, then to the rule loaded first.
+            const CustomPotion* FindFilePotion(const EffectSignature& signature) const;
+
+            // Interns a category of descriptors into this rule set
+            DescriptorCategory InternDescriptors(std::span<const std::string> categoryDescriptors);
+        };
+
+        // SKSE message types that other plugins can dispatch to this plugin ("APR" followed by an index)
+        enum MessageType : std::uint32_t {
+            kReloadRules = 0x41505200
         };
 
         static SettingsLoader* GetSingleton();
 
+        static PotencyDriver GetPotencyDriver(const RE::EffectSetting* effect);
+
+        // Renders every name a potion called this can be given, from least to most potent
+        static std::vector<std::string> RenderNames(const RuleSet& rules, std::string_view name,
+                                                    DescriptorFormat format, int descriptorIndex);
+
+        // Renders the names and builds the matcher of a rule set once all of its potions and descriptors have been
+        // added, e.g. one made up by the benchmark rather than read from the JSON files
+        static void FinishRules(RuleSet& rules);
+
+        // Builds and publishes the rule set on the calling thread
         void LoadSettings();
 
-        using PotionArray = RE::BSTArray<CustomPotion>;
+        enum class ReloadStatus {
+            Started,
+            NotLoaded,  // The game data has not loaded yet, so there are no rules to replace
+            Busy        // A reload is already running
+        };
+
+        // Rebuilds the rule set on a worker thread and publishes it once it is complete
+        ReloadStatus ReloadSettings();
+
+        // Lock-free access to the current rule set, or nullptr if none has been loaded yet.
+        // Only valid on the main thread, and only until control returns to the game.
+        const RuleSet* GetRules() const { return currentRules.load(std::memory_order_acquire); }
+
+        // Shares ownership of the current rule set, for use from any thread
+        std::shared_ptr<const RuleSet> AcquireRules() const;
+
+    private:
+        std::atomic<const RuleSet*> currentRules = nullptr;
+
+        // Owns currentRules; only touched when publishing or acquiring
+        std::shared_ptr<const RuleSet> ownedRules = {};
+        mutable std::mutex ownedRulesLock;
+
+        std::atomic_bool reloading = false;
+
+        // The thread the game data was loaded on, the only one that may read forms through the data handler
+        std::thread::id mainThreadID = {};
 
-        PotionArray potions = {};
+        // Runs a task on the main thread, waiting for it when called from elsewhere
+        void RunOnMainThread(const std::function<void()>& task) const;
 
-        using PotencyMap = std::map<std::string, std::map<std::string, float>>;
+        std::unique_ptr<RuleSet> BuildRules();
 
-        PotencyMap potencies = {};
+        void PublishRules(std::shared_ptr<const RuleSet> rules);
+
+        static void BuildPotionIndex(RuleSet& rules);
+
+        void BuildPotencyTable(RuleSet& rules, const PotencyMap& potencyMap);
+
+        static void CompileNames(RuleSet& rules);
+
+        void ReadPotionFile(RuleSet& rules, PotencyMap& potencyMap, const RuleFile& ruleFile, const FormSource& forms,
+                            std::map<std::string, int>& descriptorNameMap, int& descriptorIndex);
+
+        void ReadSettingsFile(RuleSet& rules, const std::filesystem::path& jsonPath,
+                              std::map<std::string, int>& descriptorNameMap, int& descriptorIndex);
+
+        void ReadPotionsIn(RuleSet& rules, const std::vector<PotionDefinition>& potionDefinitions,
+                           const FormSource& forms, std::map<std::string, int>& descriptorNameMap,
+                           int& descriptorIndex);
 
-        using DescriptorMap = RE::BSTArray<RE::BSTArray<std::string>>;
-        
-        DescriptorMap descriptors = {};
+        void ReadDescriptorsIn(RuleSet& rules, const DescriptorDefinitions& descriptorDefinitions,
+                               std::map<std::string, int>& descriptorNameMap, int& descriptorIndex);
 
-        bool useRomanNumerals = false;
+        // Merges the name generators of every file, the first file to define a template or fragment winning
+        void ReadGeneratorsIn(RuleSet& rules, const std::vector<RuleFile>& ruleFiles, const FormSource& forms,
+                              std::map<std::string, int>& descriptorNameMap, int& descriptorIndex);
 
-    private: 
-        
-        void ReadPotionFile(const std::filesystem::path& jsonPath, std::map<std::string, int>& descriptorNameMap,
-                            int& descriptorIndex);
+        // Returns the index of a descriptor category, adding an empty one if it has not been defined yet
+        int GetDescriptorIndex(RuleSet& rules, const std::string& descriptor,
+                               std::map<std::string, int>& descriptorNameMap, int& descriptorIndex);
 
-        void ReadSettingsFile(const std::filesystem::path& jsonPath, std::map<std::string, int>& descriptorNameMap,
-                              int& descriptorIndex);
+#ifdef APR_BUILTIN_RULES
+        void AddBuiltinRules(RuleSet& rules, PotencyMap& potencyMap, std::map<std::string, int>& descriptorNameMap,
+                             int& descriptorIndex);
+#endif
 	};
-}
\ No newline at end of file
+}
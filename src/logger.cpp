@@ -1,5 +1,7 @@
 #include "logger.h"
 
+#include "AsyncLog.h"
+
 void SetupLog() {
     auto logsFolder = SKSE::log::log_directory();
     if (!logsFolder) SKSE::stl::report_and_fail("SKSE log_directory not provided, logs disabled.");
@@ -18,4 +20,5 @@ void SetupLog() {
     spdlog::set_default_logger(std::move(loggerPtr));
     spdlog::set_level(spdlog::level::info);
     spdlog::flush_on(spdlog::level::info);
+    Diagnostics::AsyncLog::Start();
 }
\ No newline at end of file
@@ -1,5 +1,12 @@
 #include "logger.h"
 #include "AlchemyRenamer.h"
+#include "BatchRenamer.h"
+#include "ConsoleCommand.h"
+#include "Coverage.h"
+#include "EditorIDIndex.h"
+#include "EnchantmentRenamer.h"
+#include "NamePreview.h"
+#include "Profiler.h"
 #include "SettingsLoader.h"
 
 SKSEPluginLoad(const SKSE::LoadInterface* skse) {
@@ -7,16 +14,42 @@ SKSEPluginLoad(const SKSE::LoadInterface* skse) {
     SKSE::AllocTrampoline(28);
 
     SetupLog();
+#ifdef APR_PROFILING
+    Diagnostics::Profiler::Init();
+#endif
     logger::info("Logging started. Setting up hook...");
     
     Hooks::AlchemyRenamer::SetUpHook();
+    Settings::EditorIDIndex::SetUpHook();
 
     // Ensure that the DataHandler is ready before loading settings so that it can be used to look up formIDs
     SKSE::GetMessagingInterface()->RegisterListener([](auto msg) {
         switch (msg->type) {
             case SKSE::MessagingInterface::kDataLoaded: {
+                Settings::EditorIDIndex::Build();
                 logger::info("Loading settings...");
                 Settings::SettingsLoader::GetSingleton()->LoadSettings();
+                Diagnostics::Coverage::Start();
+                Console::ConsoleCommand::Register();
+                Hooks::NamePreview::Register();
+                Hooks::EnchantmentRenamer::Register();
+            } break;
+            case SKSE::MessagingInterface::kPreLoadGame: {
+                Hooks::BatchRenamer::Cancel();
+            } break;
+            case SKSE::MessagingInterface::kPostLoadGame: {
+                // Items in the save may have been named by older rules, or crafted before the plugin was installed
+                Hooks::BatchRenamer::Start();
+            } break;
+        }
+    });
+
+    // Messages sent to this plugin by other plugins
+    SKSE::GetMessagingInterface()->RegisterListener(nullptr, [](auto msg) {
+        switch (msg->type) {
+            case Settings::SettingsLoader::kReloadRules: {
+                logger::info("Received reload request from {}", msg->sender ? msg->sender : "unknown sender");
+                Settings::SettingsLoader::GetSingleton()->ReloadSettings();
             } break;
         }
     });